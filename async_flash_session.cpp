@@ -0,0 +1,289 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "async_flash_session.h"
+
+#include <QJsonDocument>
+#include <QtEndian>
+
+namespace flasher {
+namespace {
+
+constexpr qint64 kMinBaudRate {115200};     //!< Packet ACK timeout covers the transfer at the slowest link
+
+bool IsMessageWithCrcComplete(const QByteArray& rx_data) {
+    bool is_complete = false;
+
+    if (rx_data.size() > kCrc32Size) {
+        const int data_size = rx_data.size() - kCrc32Size;
+        const uint32_t crc = qFromBigEndian<quint32>(rx_data.constData() + data_size);
+        is_complete = (crc == crc::CalculateCrc32(reinterpret_cast<const uint8_t *>(rx_data.constData()), data_size, false, false));
+    }
+
+    return is_complete;
+}
+
+// Size of the JSON message with CRC at the start of the data, 0 if data does not start with a complete one
+int LeadingMessageWithCrcSize(const QByteArray& rx_data) {
+    for (int end = rx_data.indexOf('}'); end >= 0; end = rx_data.indexOf('}', end + 1)) {
+        const int size = end + 1 + kCrc32Size;
+        if ((size <= rx_data.size()) && IsMessageWithCrcComplete(rx_data.left(size))) {
+            return size;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+AsyncFlashSession::AsyncFlashSession(QIODevice& device, const QByteArray& file_content) :
+    device_(device),
+    file_content_(file_content) {
+    timeout_timer_.setSingleShot(true);
+    connect(&timeout_timer_, &QTimer::timeout, this, [this]() {
+        // Capabilities may still arrive, received part is kept so the whole late reply is dropped later
+        if (step_ == Step::kCollectCapabilities) {
+            is_capabilities_reply_late_ = true;
+        } else {
+            rx_data_.clear();
+        }
+        HandleAck(false);
+    });
+    connect(&device_, &QIODevice::readyRead, this, &AsyncFlashSession::ReadyRead);
+}
+
+AsyncFlashSession::~AsyncFlashSession() = default;
+
+void AsyncFlashSession::Start() {
+    step_ = Step::kCollectCapabilities;
+    is_capabilities_reply_late_ = false;
+    packet_size_ = kPacketSize;
+    max_packet_size_ = kPacketSize;
+    SendRequest(kCapabilitiesJsonCmd, sizeof(kCapabilitiesJsonCmd), kCapabilitiesTimeoutInMs);
+}
+
+FlashingInfo AsyncFlashSession::GetFlashingInfo() const {
+    return flashing_info_;
+}
+
+void AsyncFlashSession::ReadyRead() {
+    rx_data_.append(device_.readAll());
+
+    // Capabilities arrive as JSON followed by its CRC, older bootloaders refuse the request or do not answer at all
+    if (step_ == Step::kCollectCapabilities) {
+        if (IsMessageWithCrcComplete(rx_data_)) {
+            timeout_timer_.stop();
+            const QJsonObject capabilities = QJsonDocument::fromJson(rx_data_.left(rx_data_.size() - kCrc32Size)).object();
+            rx_data_.clear();
+            HandleCapabilities(capabilities);
+            return;
+        }
+
+        // Short timeout is meant for a missing reply, reply that is still arriving is waited for
+        if (!rx_data_.isEmpty()) {
+            timeout_timer_.start(kCapabilitiesTimeoutInMs);
+        }
+
+    } else if (is_capabilities_reply_late_) {
+        // Late capabilities would hide the ACK of the current step
+        const int late_reply_size = LeadingMessageWithCrcSize(rx_data_);
+        if (late_reply_size > 0) {
+            rx_data_.remove(0, late_reply_size);
+            is_capabilities_reply_late_ = false;
+        }
+    }
+
+    const bool is_ack = (0 == qstricmp(rx_data_.constData(), "OK"));
+    const bool is_nok = (0 == qstricmp(rx_data_.constData(), "NOK"));
+
+    if ((step_ != Step::kDone) && (is_ack || is_nok)) {
+        timeout_timer_.stop();
+        rx_data_.clear();
+        HandleAck(is_ack);
+    }
+}
+
+void AsyncFlashSession::HandleAck(bool is_ack) {
+    switch (step_) {
+
+        case Step::kCollectCapabilities:
+            HandleCapabilities(QJsonObject());
+            break;
+
+        case Step::kCheckSignature:
+            if (is_ack) {
+                step_ = Step::kSendSignature;
+                SendRequest(file_content_.constData(), qMin(kSignatureSize, static_cast<qint64>(file_content_.size())), kSerialTimeoutInMs);
+            } else {
+                Finish(false, "Check signature problem");
+            }
+            break;
+
+        case Step::kSendSignature:
+            // As in the console, file without a signature is flashed as a whole
+            signature_size_ = is_ack ? kSignatureSize : 0;
+            step_ = Step::kVerifyFlasher;
+            SendRequest(kVerifyFlasherCmd, sizeof(kVerifyFlasherCmd), kSerialTimeoutInMs);
+            break;
+
+        case Step::kVerifyFlasher:
+            if (!is_ack) {
+                Finish(false, "Verify flasher problem");
+            } else if (max_packet_size_ > kPacketSize) {
+                const QByteArray set_packet_size_cmd = kSetPacketSizeCmd + QByteArray::number(max_packet_size_);
+                step_ = Step::kSetPacketSize;
+                SendRequest(set_packet_size_cmd.constData(), set_packet_size_cmd.size() + 1, kSerialTimeoutInMs);
+            } else {
+                SendFileSize();
+            }
+            break;
+
+        case Step::kSetPacketSize:
+            // Default packet size stays in use if bootloader refuses
+            if (is_ack) {
+                packet_size_ = max_packet_size_;
+            }
+            SendFileSize();
+            break;
+
+        case Step::kSendFileSize:
+            if (is_ack) {
+                step_ = Step::kErase;
+                SendRequest(kEraseCmd, sizeof(kEraseCmd), kEraseTimeoutInMs);
+            } else {
+                Finish(false, "Send file size problem");
+            }
+            break;
+
+        case Step::kErase:
+            if (is_ack) {
+                step_ = Step::kFlash;
+                sent_size_ = 0;
+                crc::InitCrc32(image_crc_, false, false);
+
+                // Empty image has no packets, zero length packet would only time out
+                if (file_content_.size() > signature_size_) {
+                    SendNextPacket();
+                } else {
+                    SendCrc();
+                }
+            } else {
+                Finish(false, "Erasing problem");
+            }
+            break;
+
+        case Step::kFlash:
+            if (!is_ack) {
+                Finish(false, "Problem with flashing");
+            } else if (sent_size_ < (file_content_.size() - signature_size_)) {
+                SendNextPacket();
+            } else {
+                SendCrc();
+            }
+            break;
+
+        case Step::kCheckCrc:
+            if (is_ack) {
+                Finish(true, "Successful flashing process");
+            } else {
+                Finish(false, "CRC problem");
+            }
+            break;
+
+        case Step::kDone:
+        default:
+            break;
+    }
+}
+
+void AsyncFlashSession::HandleCapabilities(const QJsonObject& capabilities) {
+    // Packets are kept aligned to the default packet size, bootloader writes flash in those units
+    const qint64 max_packet_size = capabilities.value("max_packet_size").toInt(kPacketSize);
+    max_packet_size_ = qBound(kPacketSize, (max_packet_size / kPacketSize) * kPacketSize, kMaxPacketSize);
+
+    step_ = Step::kCheckSignature;
+    SendRequest(kCheckSignatureCmd, sizeof(kCheckSignatureCmd), kSerialTimeoutInMs);
+}
+
+void AsyncFlashSession::SendFileSize() {
+    const QByteArray file_size = QByteArray::number(file_content_.size() - signature_size_);
+    step_ = Step::kSendFileSize;
+    SendRequest(file_size.constData(), file_size.size(), kSerialTimeoutInMs);
+}
+
+void AsyncFlashSession::SendNextPacket() {
+    const qint64 file_size = file_content_.size() - signature_size_;
+    const char *data_position = file_content_.constData() + signature_size_ + sent_size_;
+    const qint64 length = qMin(packet_size_, file_size - sent_size_);
+
+    crc::UpdateCrc32(image_crc_, reinterpret_cast<const uint8_t *>(data_position), length);
+    sent_size_ += length;
+
+    const qint8 progress_percentage = static_cast<qint8>((file_size > 0) ? ((100 * sent_size_) / file_size) : 100);
+    if (last_progress_percentage_ != progress_percentage) {
+        last_progress_percentage_ = progress_percentage;
+        emit Progress(progress_percentage);
+    }
+
+    SendRequest(data_position, length, kSerialTimeoutInMs + static_cast<int>((length * 10 * 1000) / kMinBaudRate));
+}
+
+void AsyncFlashSession::SendCrc() {
+    const QByteArray crc = QByteArray::number(crc::FinalizeCrc32(image_crc_));
+    step_ = Step::kCheckCrc;
+    SendRequest(crc.constData(), crc.size(), kSerialTimeoutInMs);
+}
+
+void AsyncFlashSession::SendRequest(const char *data, qint64 length, int timeout_ms) {
+    // Part of the late capabilities is kept until the whole reply is dropped
+    if (!is_capabilities_reply_late_) {
+        rx_data_.clear();
+    }
+    device_.write(data, length);
+    timeout_timer_.start(timeout_ms);
+}
+
+void AsyncFlashSession::Finish(bool success, const QString& description) {
+    step_ = Step::kDone;
+    timeout_timer_.stop();
+
+    flashing_info_.success = success;
+    flashing_info_.title = success ? "Flashing process done" : "Flashing process failed";
+    flashing_info_.description = description;
+
+    emit Finished(success);
+}
+
+} // namespace flasher
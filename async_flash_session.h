@@ -0,0 +1,177 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef ASYNC_FLASH_SESSION_H_
+#define ASYNC_FLASH_SESSION_H_
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QObject>
+#include <QTimer>
+
+#include "crc32.h"
+#include "flasher_protocol.h"
+#include "flashing_info.h"
+
+namespace flasher {
+
+/*!
+ * \brief The AsyncFlashSession class, runs the console flashing sequence (check signature ... CRC check) on one device
+ * without blocking. Every step is driven by readyRead and timeout events, so one thread with an event loop can flash
+ * many boards at the same time. Packet size is negotiated from the bootloader capabilities. Session keeps the text
+ * protocol with stop-and-wait packets, bootloader starts with them, so binary framing and window are left disabled.
+ */
+class AsyncFlashSession : public QObject {
+
+    Q_OBJECT
+
+  public:
+    /*!
+     * \brief AsyncFlashSession constructor
+     * \param device - Open device connected to the bootloader, e.g. serial port
+     * \param file_content - Image that will be flashed, implicitly shared
+     */
+    AsyncFlashSession(QIODevice& device, const QByteArray& file_content);
+
+    /*!
+     * \brief AsyncFlashSession destructor
+     */
+    ~AsyncFlashSession();
+
+    /*!
+     * \brief Start flashing, Finished signal is emitted when flashing is done
+     */
+    void Start();
+
+    /*!
+     * \brief Get flashing information, valid after Finished signal
+     * \return Flashing information
+     */
+    FlashingInfo GetFlashingInfo() const;
+
+  signals:
+    /*!
+     * \brief Progress signal
+     * \param progress_percentage - Progress in percentage
+     */
+    void Progress(const qint8& progress_percentage);
+
+    /*!
+     * \brief Finished signal
+     * \param success - True if board is successfully flashed, false otherwise
+     */
+    void Finished(bool success);
+
+  private:
+    /*!
+     * \brief The Step enum, steps of the flashing sequence
+     */
+    enum class Step {
+        kCollectCapabilities,
+        kCheckSignature,
+        kSendSignature,
+        kVerifyFlasher,
+        kSetPacketSize,
+        kSendFileSize,
+        kErase,
+        kFlash,
+        kCheckCrc,
+        kDone
+    };
+
+    /*!
+     * \brief Method used to handle ACK of the current step and send request of the next one
+     * \param is_ack - True if ACK is received, false on NOK ACK or timeout
+     */
+    void HandleAck(bool is_ack);
+
+    /*!
+     * \brief Method used to take max packet size from the bootloader capabilities and start the flashing sequence
+     * \param capabilities - Bootloader capabilities, empty if bootloader does not support them
+     */
+    void HandleCapabilities(const QJsonObject& capabilities);
+
+    /*!
+     * \brief Method used to send the image size
+     */
+    void SendFileSize();
+
+    /*!
+     * \brief Method used to collect received data, ACK is handled once complete
+     */
+    void ReadyRead();
+
+    /*!
+     * \brief Method used to send the next packet of the image
+     */
+    void SendNextPacket();
+
+    /*!
+     * \brief Method used to send CRC of the image once all packets are sent
+     */
+    void SendCrc();
+
+    /*!
+     * \brief Method used to send request and arm the timeout
+     * \param data - Pointer to data that will be sent
+     * \param length - Data length
+     * \param timeout_ms - Timeout for the ACK [ms]
+     */
+    void SendRequest(const char *data, qint64 length, int timeout_ms);
+
+    /*!
+     * \brief Method used to finish the session
+     * \param success - Flashing status
+     * \param description - Description of the result
+     */
+    void Finish(bool success, const QString& description);
+
+    QIODevice& device_;                       //!< Device connected to the bootloader
+    const QByteArray file_content_;           //!< Image that will be flashed
+    QByteArray rx_data_;                      //!< Received data of the current response
+    QTimer timeout_timer_;                    //!< Response timeout
+    Step step_ {Step::kCollectCapabilities};  //!< Current step
+    bool is_capabilities_reply_late_ {false}; //!< Capabilities timed out, their reply may still arrive
+    qint64 signature_size_ {0};               //!< Signature size
+    qint64 packet_size_ {kPacketSize};        //!< Size of the packets that are sent
+    qint64 max_packet_size_ {kPacketSize};    //!< Max packet size supported by the bootloader
+    qint64 sent_size_ {0};                    //!< Size of the image that is sent
+    qint8 last_progress_percentage_{0};       //!< Last progress percentage
+    crc::Crc32Context image_crc_;             //!< CRC of the image, updated while packets are sent
+    FlashingInfo flashing_info_;              //!< Flashing information
+};
+
+} // namespace flasher
+#endif // ASYNC_FLASH_SESSION_H_
@@ -34,89 +34,428 @@
 
 #include "crc32.h"
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32_CLMUL_KERNEL
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CRC32_TARGET_CLMUL
+#else
+#include <cpuid.h>
+#define CRC32_TARGET_CLMUL __attribute__((target("pclmul,sse4.1")))
+#endif
+#endif
+
 namespace crc {
 namespace {
 
 constexpr int kCrcTableSize {256};
+constexpr int kSliceSize {16};                      //!< Number of bytes processed in one slicing step
+constexpr uint32_t kCrcPolynomial = 0x04C11DB7U;
+constexpr uint32_t kCrcReflectedPolynomial = 0xEDB88320U;
 constexpr uint32_t kCrcInitialValue = 0xFFFFFFFFU;
 constexpr uint32_t kCrcXorValue = 0xFFFFFFFFU;
+constexpr uint32_t kMinParallelChunkSize {1U << 20U};  //!< Smaller chunks are not worth a thread
 
-const uint32_t kCrcTable[kCrcTableSize] = {
-    0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
-    0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD,
-    0x4C11DB70, 0x48D0C6C7, 0x4593E01E, 0x4152FDA9, 0x5F15ADAC, 0x5BD4B01B, 0x569796C2, 0x52568B75,
-    0x6A1936C8, 0x6ED82B7F, 0x639B0DA6, 0x675A1011, 0x791D4014, 0x7DDC5DA3, 0x709F7B7A, 0x745E66CD,
-    0x9823B6E0, 0x9CE2AB57, 0x91A18D8E, 0x95609039, 0x8B27C03C, 0x8FE6DD8B, 0x82A5FB52, 0x8664E6E5,
-    0xBE2B5B58, 0xBAEA46EF, 0xB7A96036, 0xB3687D81, 0xAD2F2D84, 0xA9EE3033, 0xA4AD16EA, 0xA06C0B5D,
-    0xD4326D90, 0xD0F37027, 0xDDB056FE, 0xD9714B49, 0xC7361B4C, 0xC3F706FB, 0xCEB42022, 0xCA753D95,
-    0xF23A8028, 0xF6FB9D9F, 0xFBB8BB46, 0xFF79A6F1, 0xE13EF6F4, 0xE5FFEB43, 0xE8BCCD9A, 0xEC7DD02D,
-    0x34867077, 0x30476DC0, 0x3D044B19, 0x39C556AE, 0x278206AB, 0x23431B1C, 0x2E003DC5, 0x2AC12072,
-    0x128E9DCF, 0x164F8078, 0x1B0CA6A1, 0x1FCDBB16, 0x018AEB13, 0x054BF6A4, 0x0808D07D, 0x0CC9CDCA,
-    0x7897AB07, 0x7C56B6B0, 0x71159069, 0x75D48DDE, 0x6B93DDDB, 0x6F52C06C, 0x6211E6B5, 0x66D0FB02,
-    0x5E9F46BF, 0x5A5E5B08, 0x571D7DD1, 0x53DC6066, 0x4D9B3063, 0x495A2DD4, 0x44190B0D, 0x40D816BA,
-    0xACA5C697, 0xA864DB20, 0xA527FDF9, 0xA1E6E04E, 0xBFA1B04B, 0xBB60ADFC, 0xB6238B25, 0xB2E29692,
-    0x8AAD2B2F, 0x8E6C3698, 0x832F1041, 0x87EE0DF6, 0x99A95DF3, 0x9D684044, 0x902B669D, 0x94EA7B2A,
-    0xE0B41DE7, 0xE4750050, 0xE9362689, 0xEDF73B3E, 0xF3B06B3B, 0xF771768C, 0xFA325055, 0xFEF34DE2,
-    0xC6BCF05F, 0xC27DEDE8, 0xCF3ECB31, 0xCBFFD686, 0xD5B88683, 0xD1799B34, 0xDC3ABDED, 0xD8FBA05A,
-    0x690CE0EE, 0x6DCDFD59, 0x608EDB80, 0x644FC637, 0x7A089632, 0x7EC98B85, 0x738AAD5C, 0x774BB0EB,
-    0x4F040D56, 0x4BC510E1, 0x46863638, 0x42472B8F, 0x5C007B8A, 0x58C1663D, 0x558240E4, 0x51435D53,
-    0x251D3B9E, 0x21DC2629, 0x2C9F00F0, 0x285E1D47, 0x36194D42, 0x32D850F5, 0x3F9B762C, 0x3B5A6B9B,
-    0x0315D626, 0x07D4CB91, 0x0A97ED48, 0x0E56F0FF, 0x1011A0FA, 0x14D0BD4D, 0x19939B94, 0x1D528623,
-    0xF12F560E, 0xF5EE4BB9, 0xF8AD6D60, 0xFC6C70D7, 0xE22B20D2, 0xE6EA3D65, 0xEBA91BBC, 0xEF68060B,
-    0xD727BBB6, 0xD3E6A601, 0xDEA580D8, 0xDA649D6F, 0xC423CD6A, 0xC0E2D0DD, 0xCDA1F604, 0xC960EBB3,
-    0xBD3E8D7E, 0xB9FF90C9, 0xB4BCB610, 0xB07DABA7, 0xAE3AFBA2, 0xAAFBE615, 0xA7B8C0CC, 0xA379DD7B,
-    0x9B3660C6, 0x9FF77D71, 0x92B45BA8, 0x9675461F, 0x8832161A, 0x8CF30BAD, 0x81B02D74, 0x857130C3,
-    0x5D8A9099, 0x594B8D2E, 0x5408ABF7, 0x50C9B640, 0x4E8EE645, 0x4A4FFBF2, 0x470CDD2B, 0x43CDC09C,
-    0x7B827D21, 0x7F436096, 0x7200464F, 0x76C15BF8, 0x68860BFD, 0x6C47164A, 0x61043093, 0x65C52D24,
-    0x119B4BE9, 0x155A565E, 0x18197087, 0x1CD86D30, 0x029F3D35, 0x065E2082, 0x0B1D065B, 0x0FDC1BEC,
-    0x3793A651, 0x3352BBE6, 0x3E119D3F, 0x3AD08088, 0x2497D08D, 0x2056CD3A, 0x2D15EBE3, 0x29D4F654,
-    0xC5A92679, 0xC1683BCE, 0xCC2B1D17, 0xC8EA00A0, 0xD6AD50A5, 0xD26C4D12, 0xDF2F6BCB, 0xDBEE767C,
-    0xE3A1CBC1, 0xE760D676, 0xEA23F0AF, 0xEEE2ED18, 0xF0A5BD1D, 0xF464A0AA, 0xF9278673, 0xFDE69BC4,
-    0x89B8FD09, 0x8D79E0BE, 0x803AC667, 0x84FBDBD0, 0x9ABC8BD5, 0x9E7D9662, 0x933EB0BB, 0x97FFAD0C,
-    0xAFB010B1, 0xAB710D06, 0xA6322BDF, 0xA2F33668, 0xBCB4666D, 0xB8757BDA, 0xB5365D03, 0xB1F740B4
+/*!
+ * \brief Slicing tables, table[k][n] is CRC of byte n followed by k zero bytes
+ */
+struct CrcTables {
+    uint32_t table[kSliceSize][kCrcTableSize];
 };
 
-uint32_t Reflect(uint32_t data, const uint8_t num_of_bits) {
-    uint32_t reflection = 0U;
+constexpr CrcTables GenerateTables() {
+    CrcTables tables {};
+
+    for (uint32_t n = 0U; n < kCrcTableSize; ++n) {
+        uint32_t crc = n << 24U;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000U) ? ((crc << 1U) ^ kCrcPolynomial) : (crc << 1U);
+        }
+        tables.table[0][n] = crc;
+    }
+
+    for (int k = 1; k < kSliceSize; ++k) {
+        for (uint32_t n = 0U; n < kCrcTableSize; ++n) {
+            const uint32_t previous = tables.table[k - 1][n];
+            tables.table[k][n] = (previous << 8U) ^ tables.table[0][previous >> 24U];
+        }
+    }
+
+    return tables;
+}
+
+constexpr CrcTables GenerateReflectedTables() {
+    CrcTables tables {};
+
+    for (uint32_t n = 0U; n < kCrcTableSize; ++n) {
+        uint32_t crc = n;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x01U) ? ((crc >> 1U) ^ kCrcReflectedPolynomial) : (crc >> 1U);
+        }
+        tables.table[0][n] = crc;
+    }
+
+    for (int k = 1; k < kSliceSize; ++k) {
+        for (uint32_t n = 0U; n < kCrcTableSize; ++n) {
+            const uint32_t previous = tables.table[k - 1][n];
+            tables.table[k][n] = (previous >> 8U) ^ tables.table[0][previous & 0xFFU];
+        }
+    }
+
+    return tables;
+}
+
+constexpr CrcTables kCrcTables = GenerateTables();
+constexpr CrcTables kCrcReflectedTables = GenerateReflectedTables();
+
+static_assert(kCrcTables.table[0][1] == 0x04C11DB7U, "Wrong CRC table");
+static_assert(kCrcTables.table[0][255] == 0xB1F740B4U, "Wrong CRC table");
+static_assert(kCrcReflectedTables.table[0][128] == 0xEDB88320U, "Wrong reflected CRC table");
+
+constexpr uint32_t Reflect32(uint32_t data) {
+    data = ((data >> 1U) & 0x55555555U) | ((data & 0x55555555U) << 1U);
+    data = ((data >> 2U) & 0x33333333U) | ((data & 0x33333333U) << 2U);
+    data = ((data >> 4U) & 0x0F0F0F0FU) | ((data & 0x0F0F0F0FU) << 4U);
+    data = ((data >> 8U) & 0x00FF00FFU) | ((data & 0x00FF00FFU) << 8U);
+    return (data >> 16U) | (data << 16U);
+}
+
+/*!
+ * \brief Update CRC register, MSB first. Input bytes are fed to the register unchanged.
+ */
+uint32_t Update(uint32_t crc, const uint8_t *data, uint32_t length) {
+    const auto& t = kCrcTables.table;
+
+    for (; length >= kSliceSize; length -= kSliceSize, data += kSliceSize) {
+        crc ^= (static_cast<uint32_t>(data[0]) << 24U) | (static_cast<uint32_t>(data[1]) << 16U) |
+               (static_cast<uint32_t>(data[2]) << 8U) | static_cast<uint32_t>(data[3]);
+
+        crc = t[15][crc >> 24U] ^ t[14][(crc >> 16U) & 0xFFU] ^ t[13][(crc >> 8U) & 0xFFU] ^ t[12][crc & 0xFFU] ^
+              t[11][data[4]] ^ t[10][data[5]] ^ t[9][data[6]] ^ t[8][data[7]] ^
+              t[7][data[8]] ^ t[6][data[9]] ^ t[5][data[10]] ^ t[4][data[11]] ^
+              t[3][data[12]] ^ t[2][data[13]] ^ t[1][data[14]] ^ t[0][data[15]];
+    }
+
+    for (; length > 0U; --length, ++data) {
+        crc = (crc << 8U) ^ t[0][(crc >> 24U) ^ *data];
+    }
+
+    return crc;
+}
+
+/*!
+ * \brief Update CRC register, LSB first. Feeding bytes LSB first is the same as feeding reflected bytes MSB first,
+ * except that the register itself ends up reflected.
+ */
+uint32_t UpdateReflected(uint32_t crc, const uint8_t *data, uint32_t length) {
+    const auto& t = kCrcReflectedTables.table;
+
+    for (; length >= kSliceSize; length -= kSliceSize, data += kSliceSize) {
+        crc ^= static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8U) |
+               (static_cast<uint32_t>(data[2]) << 16U) | (static_cast<uint32_t>(data[3]) << 24U);
+
+        crc = t[15][crc & 0xFFU] ^ t[14][(crc >> 8U) & 0xFFU] ^ t[13][(crc >> 16U) & 0xFFU] ^ t[12][crc >> 24U] ^
+              t[11][data[4]] ^ t[10][data[5]] ^ t[9][data[6]] ^ t[8][data[7]] ^
+              t[7][data[8]] ^ t[6][data[9]] ^ t[5][data[10]] ^ t[4][data[11]] ^
+              t[3][data[12]] ^ t[2][data[13]] ^ t[1][data[14]] ^ t[0][data[15]];
+    }
+
+    for (; length > 0U; --length, ++data) {
+        crc = (crc >> 8U) ^ t[0][(crc ^ *data) & 0xFFU];
+    }
+
+    return crc;
+}
+
+#ifdef CRC32_CLMUL_KERNEL
+
+constexpr uint32_t kClmulMinLength {64U};   //!< Shorter data is faster with the tables
+constexpr int kCpuidPclmulqdqBit {1};
+constexpr int kCpuidSse41Bit {19};
+
+// Folding constants, x^n mod P, and Barrett constant floor(x^64 / P)
+constexpr int64_t kXPow576 = 0x8833794C;
+constexpr int64_t kXPow512 = 0xE6228B11;
+constexpr int64_t kXPow192 = 0xC5B9CD4C;
+constexpr int64_t kXPow128 = 0xE8A45605;
+constexpr int64_t kXPow96 = 0xF200AA66;
+constexpr int64_t kXPow64 = 0x490D678D;
+constexpr int64_t kBarrettMu = 0x104D101DF;
+constexpr int64_t kPolynomial33 = 0x104C11DB7;
+
+bool DetectClmul() {
+    uint32_t ecx;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx = static_cast<uint32_t>(info[2]);
+#else
+    unsigned int eax, ebx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+#endif
+    return ((ecx >> kCpuidPclmulqdqBit) & 0x01U) && ((ecx >> kCpuidSse41Bit) & 0x01U);
+}
+
+CRC32_TARGET_CLMUL
+inline __m128i LoadBigEndian(const uint8_t *data) {
+    const __m128i byte_swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), byte_swap);
+}
+
+/*!
+ * \brief Fold 128 bit remainder forward and add next block: hi * (x^(n + 64) mod P) + lo * (x^n mod P) + next
+ */
+CRC32_TARGET_CLMUL
+inline __m128i Fold(__m128i remainder, __m128i constants, __m128i next) {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(remainder, constants, 0x11),
+                                       _mm_clmulepi64_si128(remainder, constants, 0x00)), next);
+}
+
+/*!
+ * \brief Update CRC register, MSB first, with carry-less multiply folding. Length must be at least kClmulMinLength.
+ * Whole 16 byte blocks are folded, the rest is handled by the tables.
+ */
+CRC32_TARGET_CLMUL
+uint32_t UpdateClmul(uint32_t crc, const uint8_t *data, uint32_t length) {
+    const __m128i fold_by_4 = _mm_set_epi64x(kXPow576, kXPow512);
+    const __m128i fold_by_1 = _mm_set_epi64x(kXPow192, kXPow128);
+    const __m128i reduce = _mm_set_epi64x(kXPow64, kXPow96);
+    const __m128i barrett = _mm_set_epi64x(kPolynomial33, kBarrettMu);
+    const __m128i mask_low64 = _mm_set_epi64x(0, -1);
+
+    __m128i x0 = _mm_xor_si128(LoadBigEndian(data), _mm_set_epi32(static_cast<int>(crc), 0, 0, 0));
+    __m128i x1 = LoadBigEndian(data + 16);
+    __m128i x2 = LoadBigEndian(data + 32);
+    __m128i x3 = LoadBigEndian(data + 48);
+    data += 64;
+    length -= 64U;
+
+    for (; length >= 64U; length -= 64U, data += 64) {
+        x0 = Fold(x0, fold_by_4, LoadBigEndian(data));
+        x1 = Fold(x1, fold_by_4, LoadBigEndian(data + 16));
+        x2 = Fold(x2, fold_by_4, LoadBigEndian(data + 32));
+        x3 = Fold(x3, fold_by_4, LoadBigEndian(data + 48));
+    }
+
+    __m128i x = Fold(Fold(Fold(x0, fold_by_1, x1), fold_by_1, x2), fold_by_1, x3);
+
+    for (; length >= 16U; length -= 16U, data += 16) {
+        x = Fold(x, fold_by_1, LoadBigEndian(data));
+    }
+
+    // 128 bit remainder times x^32 down to 64 bits, then Barrett reduction to 32 bits
+    const __m128i t = _mm_xor_si128(_mm_clmulepi64_si128(x, reduce, 0x01), _mm_slli_si128(_mm_and_si128(x, mask_low64), 4));
+    const __m128i u = _mm_xor_si128(_mm_clmulepi64_si128(_mm_srli_si128(t, 8), reduce, 0x10), _mm_and_si128(t, mask_low64));
+    __m128i q = _mm_clmulepi64_si128(_mm_srli_epi64(u, 32), barrett, 0x00);
+    q = _mm_clmulepi64_si128(_mm_srli_epi64(q, 32), barrett, 0x10);
+    crc = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_xor_si128(u, q)));
+
+    return Update(crc, data, length);
+}
+
+#endif // CRC32_CLMUL_KERNEL
+
+/*!
+ * \brief Update CRC register, MSB first, with the fastest kernel the CPU supports
+ */
+uint32_t UpdateDispatch(uint32_t crc, const uint8_t *data, uint32_t length) {
+#ifdef CRC32_CLMUL_KERNEL
+    if ((length >= kClmulMinLength) && IsClmulSupported()) {
+        return UpdateClmul(crc, data, length);
+    }
+#endif
+    return Update(crc, data, length);
+}
 
-    // Reflect the data about the center bit.
-    for (uint8_t bit = 0U; bit < num_of_bits; ++bit) {
-        // If the LSB bit is set, set the reflection of it.
-        if (data & 0x01U) {
-            reflection |= (1U << ((num_of_bits - 1U) - bit));
+/*!
+ * \brief Multiply two polynomials modulo P, MSB first representation
+ */
+uint32_t MultiplyModP(uint32_t a, uint32_t b) {
+    uint32_t product = 0U;
+
+    for (int bit = 31; bit >= 0; --bit) {
+        product = (product & 0x80000000U) ? ((product << 1U) ^ kCrcPolynomial) : (product << 1U);
+        if ((b >> bit) & 0x01U) {
+            product ^= a;
         }
+    }
 
-        data = (data >> 1U);
+    return product;
+}
+
+/*!
+ * \brief Calculate x^(8 * length) modulo P by square and multiply
+ */
+uint32_t XPowModP(uint64_t length) {
+    uint32_t result = 0x00000001U;      // x^0
+    uint32_t power = 0x00000100U;       // x^8
+
+    while (length > 0U) {
+        if (length & 0x01U) {
+            result = MultiplyModP(result, power);
+        }
+        power = MultiplyModP(power, power);
+        length >>= 1U;
     }
 
-    return reflection;
+    return result;
+}
+
+template <bool kReflectedOutput, bool kReflectedInput>
+uint32_t Calculate(const uint8_t *data, const uint32_t length);
+
+template <>
+uint32_t Calculate<false, false>(const uint8_t *data, const uint32_t length) {
+    return UpdateDispatch(kCrcInitialValue, data, length) ^ kCrcXorValue;
+}
+
+template <>
+uint32_t Calculate<true, false>(const uint8_t *data, const uint32_t length) {
+    return Reflect32(UpdateDispatch(kCrcInitialValue, data, length) ^ kCrcXorValue);
+}
+
+template <>
+uint32_t Calculate<false, true>(const uint8_t *data, const uint32_t length) {
+    return Reflect32(UpdateReflected(kCrcInitialValue, data, length) ^ kCrcXorValue);
+}
+
+template <>
+uint32_t Calculate<true, true>(const uint8_t *data, const uint32_t length) {
+    return UpdateReflected(kCrcInitialValue, data, length) ^ kCrcXorValue;
 }
 
 } // namespace
 
-uint32_t CalculateCrc32(
+bool IsClmulSupported() {
+#ifdef CRC32_CLMUL_KERNEL
+    static const bool is_supported = DetectClmul();
+    return is_supported;
+#else
+    return false;
+#endif
+}
+
+uint32_t CalculateCrc32Clmul(
     const uint8_t *data,
     const uint32_t length,
+    const bool reflected_output) {
+    uint32_t crc = kCrcInitialValue;
+
+#ifdef CRC32_CLMUL_KERNEL
+    if ((length >= kClmulMinLength) && IsClmulSupported()) {
+        crc = UpdateClmul(crc, data, length);
+    } else {
+        crc = Update(crc, data, length);
+    }
+#else
+    crc = Update(crc, data, length);
+#endif
+
+    crc ^= kCrcXorValue;
+
+    return reflected_output ? Reflect32(crc) : crc;
+}
+
+void InitCrc32(
+    Crc32Context& context,
     const bool reflected_output,
     const bool reflected_input) {
-    uint8_t temp;
-    uint32_t crc = kCrcInitialValue;
+    context.crc = kCrcInitialValue;
+    context.length = 0U;
+    context.reflected_output = reflected_output;
+    context.reflected_input = reflected_input;
+}
 
-    for (uint32_t i = 0U; i < length; ++i) {
-        if (reflected_input) {
-            temp = Reflect(*data, 8U);
-        } else {
-            temp = *data;
-        }
+void UpdateCrc32(
+    Crc32Context& context,
+    const uint8_t *data,
+    const uint32_t length) {
+    // Reflected input keeps the register in LSB first form, see UpdateReflected()
+    if (context.reflected_input) {
+        context.crc = UpdateReflected(context.crc, data, length);
+    } else {
+        context.crc = UpdateDispatch(context.crc, data, length);
+    }
+
+    context.length += length;
+}
+
+uint32_t FinalizeCrc32(const Crc32Context& context) {
+    uint32_t crc = context.crc ^ kCrcXorValue;
 
-        crc = (crc << 8U) ^ kCrcTable[static_cast<uint8_t>((crc >> 24U) ^ temp)];
-        ++data;
+    if (context.reflected_input != context.reflected_output) {
+        crc = Reflect32(crc);
     }
 
-    crc ^= kCrcXorValue;
+    return crc;
+}
+
+uint32_t CombineCrc32(
+    const uint32_t crc1,
+    const uint32_t crc2,
+    const uint64_t length2) {
+    // Initial and XOR value are equal, so they cancel out and only the first CRC has to be shifted over the second data
+    return MultiplyModP(crc1, XPowModP(length2)) ^ crc2;
+}
+
+uint32_t CalculateCrc32Parallel(
+    const uint8_t *data,
+    const uint32_t length,
+    const bool reflected_output) {
+    const uint32_t num_of_threads = std::min<uint32_t>(std::max(std::thread::hardware_concurrency(), 1U), length / kMinParallelChunkSize);
+
+    if (num_of_threads < 2U) {
+        return CalculateCrc32(data, length, reflected_output, false);
+    }
+
+    const uint32_t chunk_size = length / num_of_threads;
+    std::vector<uint32_t> chunk_crcs(num_of_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(num_of_threads - 1U);
+
+    auto chunk_length = [&](uint32_t chunk) {
+        return (chunk == (num_of_threads - 1U)) ? (length - (chunk * chunk_size)) : chunk_size;
+    };
+
+    for (uint32_t chunk = 1U; chunk < num_of_threads; ++chunk) {
+        threads.emplace_back([&, chunk] {
+            chunk_crcs[chunk] = CalculateCrc32(data + (chunk * chunk_size), chunk_length(chunk), false, false);
+        });
+    }
+
+    // Calling thread takes the first chunk
+    chunk_crcs[0] = CalculateCrc32(data, chunk_size, false, false);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    uint32_t crc = chunk_crcs[0];
+    for (uint32_t chunk = 1U; chunk < num_of_threads; ++chunk) {
+        crc = CombineCrc32(crc, chunk_crcs[chunk], chunk_length(chunk));
+    }
+
+    return reflected_output ? Reflect32(crc) : crc;
+}
+
+uint32_t CalculateCrc32(
+    const uint8_t *data,
+    const uint32_t length,
+    const bool reflected_output,
+    const bool reflected_input) {
+    uint32_t crc;
 
-    if (reflected_output) {
-        crc = Reflect(crc, sizeof(uint32_t) * 8U);
+    if (reflected_input) {
+        crc = reflected_output ? Calculate<true, true>(data, length) : Calculate<false, true>(data, length);
+    } else {
+        crc = reflected_output ? Calculate<true, false>(data, length) : Calculate<false, false>(data, length);
     }
 
     return crc;
@@ -38,6 +38,17 @@
 #include <cstdint>
 
 namespace crc {
+
+/*!
+ * \brief The Crc32Context struct, state of CRC32 that is calculated incrementally
+ */
+struct Crc32Context {
+    uint32_t crc {0U};                  //!< CRC register in internal representation
+    uint64_t length {0U};               //!< Number of bytes processed so far
+    bool reflected_output {false};      //!< Flag that determines if output should be reflected
+    bool reflected_input {false};       //!< Flag that determines if input should be reflected
+};
+
 /*!
  * \brief Calculate CRC32
  * \param data - Pointer to data on which CRC32 will be calculated
@@ -52,5 +63,80 @@ uint32_t CalculateCrc32(
     const bool reflected_output,
     const bool reflected_input);
 
+/*!
+ * \brief Initialize incremental CRC32 calculation
+ * \param context - CRC32 context that will be initialized
+ * \param reflected_output - Flag that determines if output should be reflected
+ * \param reflected_input - Flag that determines if input should be reflected
+ */
+void InitCrc32(
+    Crc32Context& context,
+    const bool reflected_output,
+    const bool reflected_input);
+
+/*!
+ * \brief Update incremental CRC32 calculation with the next chunk of data
+ * \param context - CRC32 context
+ * \param data - Pointer to data chunk
+ * \param length - Data chunk length
+ */
+void UpdateCrc32(
+    Crc32Context& context,
+    const uint8_t *data,
+    const uint32_t length);
+
+/*!
+ * \brief Finalize incremental CRC32 calculation. Context is not changed, so more data can be added afterwards.
+ * \param context - CRC32 context
+ * \return CRC32 of all data that is passed to the context, same as CalculateCrc32() over the whole data
+ */
+uint32_t FinalizeCrc32(const Crc32Context& context);
+
+/*!
+ * \brief Combine CRC32 of two consecutive data blocks into CRC32 of the concatenated data. Valid for non-reflected
+ * input and output, as used for image CRC.
+ * \param crc1 - CRC32 of the first block
+ * \param crc2 - CRC32 of the second block
+ * \param length2 - Length of the second block
+ * \return CRC32 of the first block followed by the second block
+ */
+uint32_t CombineCrc32(
+    const uint32_t crc1,
+    const uint32_t crc2,
+    const uint64_t length2);
+
+/*!
+ * \brief Calculate CRC32 of non-reflected input on all CPU cores. Data is split into one chunk per core and partial CRCs
+ * are merged with CombineCrc32(). Data smaller than a few MB is calculated on the calling thread.
+ * \param data - Pointer to data on which CRC32 will be calculated
+ * \param length - Data length
+ * \param reflected_output - Flag that determines if output should be reflected
+ * \return Calculated CRC32, same as CalculateCrc32()
+ */
+uint32_t CalculateCrc32Parallel(
+    const uint8_t *data,
+    const uint32_t length,
+    const bool reflected_output);
+
+/*!
+ * \brief Check if CPU supports carry-less multiply (PCLMULQDQ and SSE4.1) CRC32 kernel
+ * \return True if kernel is supported, false otherwise
+ */
+bool IsClmulSupported();
+
+/*!
+ * \brief Calculate CRC32 of non-reflected input with carry-less multiply folding kernel. CalculateCrc32() uses the same
+ * kernel for long non-reflected input, this entry point exists so the kernel can be checked against the tables.
+ * Falls back to the table driven implementation if the kernel is not supported or data is short.
+ * \param data - Pointer to data on which CRC32 will be calculated
+ * \param length - Data length
+ * \param reflected_output - Flag that determines if output should be reflected
+ * \return Calculated CRC32
+ */
+uint32_t CalculateCrc32Clmul(
+    const uint8_t *data,
+    const uint32_t length,
+    const bool reflected_output);
+
 } // namespace crc
 #endif // CRC32_H_
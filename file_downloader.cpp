@@ -34,8 +34,42 @@
 
 #include "file_downloader.h"
 
+#include <QEventLoop>
+#include <QTimer>
+
 namespace file_downloader {
 
+namespace {
+
+constexpr int kNoDataTimeoutInMs {5000};    //!< Streamed download is aborted when no data arrives for this long
+
+// Reply without HTTP status is a local file, redirect or error page is never taken for the file
+bool IsStatusOk(const QNetworkReply *reply) {
+    const QVariant status_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    return !status_code.isValid() || ((status_code.toInt() >= 200) && (status_code.toInt() < 300));
+}
+
+// Weak ETag may stay the same when content changes, modification time is used instead
+QString ValidatorOf(const QNetworkReply *reply) {
+    if (!IsStatusOk(reply)) {
+        return QString();
+    }
+
+    const QByteArray etag = reply->rawHeader("ETag");
+    if (!etag.isEmpty() && !etag.startsWith("W/")) {
+        return QString::fromLatin1("etag " + etag);
+    }
+
+    const QByteArray last_modified = reply->rawHeader("Last-Modified");
+    if (!last_modified.isEmpty()) {
+        return QString::fromLatin1("last-modified " + last_modified);
+    }
+
+    return QString();
+}
+
+} // namespace
+
 FileDownloader::FileDownloader() = default;
 FileDownloader::~FileDownloader() = default;
 
@@ -45,6 +79,16 @@ void FileDownloader::StartDownload(const QUrl& url) {
     reply_ = net_access_manager_.get(request);
     connect(reply_, &QNetworkReply::downloadProgress, this, &FileDownloader::SetDownloadProgress);
     connect(reply_, &QNetworkReply::finished, this, &FileDownloader::FileDownloaded);
+    QNetworkReply *reply = reply_;
+    connect(reply_, &QNetworkReply::metaDataChanged, this, [this, reply]() {
+        emit ValidatorReceived(ValidatorOf(reply));
+    });
+}
+
+void FileDownloader::AbortDownload() {
+    if (reply_) {
+        reply_->abort();
+    }
 }
 
 void FileDownloader::SetDownloadProgress(qint64 bytes_received, qint64 bytes_total) {
@@ -55,6 +99,88 @@ void FileDownloader::FileDownloaded() {
     emit Downloaded();
 }
 
+bool FileDownloader::DownloadStream(const QUrl& url, const FileSizeHandler& handle_file_size, const ChunkConsumer& consume_chunk,
+                                    const PendingDataHandler& handle_pending_data, const ValidatorHandler& handle_validator) {
+    QNetworkRequest request(url);
+    request.setSslConfiguration(QSslConfiguration::defaultConfiguration());
+    // Compressed reply would not match its announced length
+    request.setRawHeader("Accept-Encoding", "identity");
+    // Qt does not follow redirects by default, it reports redirect as a successful reply
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+
+    QNetworkReply *reply = net_access_manager_.get(request);
+    bool is_size_known = false;
+    bool is_validator_checked = false;
+    bool is_file_needed = true;
+    bool success = true;
+    QByteArray pending_data;
+
+    // Network access manager has no timeout of its own, stalled download would block forever
+    QTimer no_data_timer;
+    no_data_timer.setSingleShot(true);
+    no_data_timer.setInterval(kNoDataTimeoutInMs);
+    connect(&no_data_timer, &QTimer::timeout, reply, &QNetworkReply::abort);
+    no_data_timer.start();
+
+    auto read_available = [&]() {
+        no_data_timer.start();
+
+        if (!is_file_needed) {
+            return;
+        }
+
+        // File that is already available is not downloaded, validator of a redirect or an error page is never checked
+        if (!is_validator_checked && handle_validator && IsStatusOk(reply)) {
+            is_validator_checked = true;
+            if (!handle_validator(ValidatorOf(reply))) {
+                is_file_needed = false;
+                reply->abort();
+                return;
+            }
+        }
+
+        // Size of an error page is not announced, data without size is held back until final status is known
+        if (!is_size_known && IsStatusOk(reply) && reply->header(QNetworkRequest::ContentLengthHeader).isValid()) {
+            handle_file_size(reply->header(QNetworkRequest::ContentLengthHeader).toLongLong());
+            is_size_known = true;
+        }
+
+        const QByteArray data = reply->readAll();
+        if (!is_size_known) {
+            pending_data.append(data);
+            if (handle_pending_data && !data.isEmpty()) {
+                handle_pending_data(data.size());
+            }
+        } else if (success && !data.isEmpty() && !consume_chunk(data.constData(), data.size())) {
+            success = false;
+            reply->abort();
+        }
+    };
+
+    QEventLoop loop;
+    connect(reply, &QNetworkReply::readyRead, &loop, read_available);
+    connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    if (!reply->isFinished()) {
+        loop.exec();
+    }
+    read_available();
+
+    if (!is_file_needed) {
+        reply->deleteLater();
+        return true;
+    }
+
+    success = success && (reply->error() == QNetworkReply::NoError) && IsStatusOk(reply);
+    if (success && !is_size_known) {
+        handle_file_size(pending_data.size());
+        success = pending_data.isEmpty() || consume_chunk(pending_data.constData(), pending_data.size());
+    }
+
+    reply->deleteLater();
+
+    return success;
+}
+
 bool FileDownloader::GetDownloadedData(QByteArray& downloaded_data) {
 
     bool success = false;
@@ -62,6 +188,7 @@ bool FileDownloader::GetDownloadedData(QByteArray& downloaded_data) {
     if (reply_) {
         downloaded_data = reply_->readAll();
         reply_->deleteLater();
+        reply_ = nullptr;
         success = true;
     }
 
@@ -35,6 +35,7 @@
 #ifndef FILE_DOWNLOADER_H_
 #define FILE_DOWNLOADER_H_
 
+#include <functional>
 #include <QObject>
 #include <QByteArray>
 #include <QNetworkAccessManager>
@@ -51,6 +52,28 @@ class FileDownloader : public QObject {
     Q_OBJECT
 
   public:
+    /*!
+     * \brief Function that receives downloaded data as it arrives, returns false to abort the download
+     */
+    using ChunkConsumer = std::function<bool(const char *chunk, int size)>;
+
+    /*!
+     * \brief Function that receives file size before the first chunk
+     */
+    using FileSizeHandler = std::function<void(qint64 file_size)>;
+
+    /*!
+     * \brief Function that is notified about data held back while file size is unknown
+     */
+    using PendingDataHandler = std::function<void(qint64 size)>;
+
+    /*!
+     * \brief Function that receives validator of the file content, strong ETag or Last-Modified of the reply, before
+     * the first chunk. Validator is empty if reply has none. It returns false if file content is not needed, e.g. file is
+     * already cached.
+     */
+    using ValidatorHandler = std::function<bool(const QString& validator)>;
+
     /*!
      * \brief FileDownloader constructor
      */
@@ -67,6 +90,11 @@ class FileDownloader : public QObject {
     */
     virtual void StartDownload(const QUrl& url);
 
+    /*!
+     * \brief Abort download started by StartDownload, Downloaded signal is emitted
+     */
+    virtual void AbortDownload();
+
     /*!
      * \brief Get downloaded data
      * \param downloaded_data - Data that is downloaded
@@ -74,12 +102,32 @@ class FileDownloader : public QObject {
      */
     virtual bool GetDownloadedData(QByteArray& downloaded_data);
 
+    /*!
+     * \brief Download file and deliver it as it arrives, blocks until download is finished. File size is taken from
+     * the reply header, file without it is delivered at once when it is complete.
+     * \param url - URL
+     * \param handle_file_size - Function that receives file size
+     * \param consume_chunk - Function that receives file chunks
+     * \param handle_pending_data - Optional function that is notified about data held back while file size is unknown
+     * \param handle_validator - Optional function that receives validator of the file and decides if file is downloaded
+     * \return True if whole file is delivered or file is not needed, false otherwise
+     */
+    virtual bool DownloadStream(const QUrl& url, const FileSizeHandler& handle_file_size, const ChunkConsumer& consume_chunk,
+                                const PendingDataHandler& handle_pending_data = PendingDataHandler(),
+                                const ValidatorHandler& handle_validator = ValidatorHandler());
+
   signals:
     /*!
      * \brief Signals that data is downloaded
      */
     void Downloaded();
 
+    /*!
+     * \brief Signals validator of the file content that is downloaded by StartDownload, before its data
+     * \param validator - Strong ETag or Last-Modified of the reply, empty if reply has none
+     */
+    void ValidatorReceived(const QString& validator);
+
     /*!
      * \brief Signal download progress
      * \param bytes_received - Number of received bytes
@@ -102,7 +150,7 @@ class FileDownloader : public QObject {
 
   private:
     QNetworkAccessManager net_access_manager_;  //!< Network access manager
-    QNetworkReply *reply_;                      //!< Pointer to network reply
+    QNetworkReply *reply_{nullptr};             //!< Pointer to network reply
 };
 
 } // namespace file_downloader
@@ -0,0 +1,217 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "firmware_cache.h"
+
+#include <mutex>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+namespace firmware_cache {
+
+namespace {
+
+constexpr char kIndexFileName[] = "index.json";
+constexpr char kEntriesStr[] = "entries";
+constexpr char kUseCountStr[] = "use_count";
+constexpr char kHashStr[] = "hash";
+constexpr char kSizeStr[] = "size";
+constexpr char kLastUseStr[] = "last_use";
+
+std::mutex cache_mutex;     //!< Cache directory is shared by all flashers in the process
+
+QString HashOf(const QByteArray& content) {
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex();
+}
+
+qint64 SizeOf(const QJsonObject& entry) {
+    return static_cast<qint64>(entry.value(kSizeStr).toDouble());
+}
+
+} // namespace
+
+FirmwareCache::FirmwareCache(const QString& directory, qint64 max_size) :
+    directory_(directory),
+    max_size_(max_size) {}
+
+QString FirmwareCache::MakeKey(const QString& product_type, const QString& file_version, const QString& origin, const QString& file_checksum) {
+    return product_type + '/' + file_version + '/' + origin + '/' + file_checksum;
+}
+
+bool FirmwareCache::Load(const QString& key, QByteArray& content) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    QJsonObject index = ReadIndex();
+    QJsonObject entries = index.value(kEntriesStr).toObject();
+    QJsonObject entry = entries.value(key).toObject();
+
+    if (entry.isEmpty()) {
+        return false;
+    }
+
+    const QString hash = entry.value(kHashStr).toString();
+    QFile file(FilePath(hash));
+    bool success = file.open(QIODevice::ReadOnly);
+
+    if (success) {
+        content = file.readAll();
+        file.close();
+    }
+
+    // Content is checked on every read, damaged file is removed so it is downloaded again
+    success = success && (content.size() == SizeOf(entry)) && (HashOf(content) == hash);
+
+    if (success) {
+        const int use_count = index.value(kUseCountStr).toInt() + 1;
+        entry.insert(kLastUseStr, use_count);
+        entries.insert(key, entry);
+        index.insert(kUseCountStr, use_count);
+    } else {
+        qInfo() << "Cached file " << key << " is damaged";
+        content.clear();
+        RemoveFile(entries, hash);
+    }
+
+    index.insert(kEntriesStr, entries);
+    WriteIndex(index);
+
+    return success;
+}
+
+bool FirmwareCache::Store(const QString& key, const QByteArray& content) {
+    if (content.size() > max_size_) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (!directory_.mkpath(".")) {
+        return false;
+    }
+
+    // Same content is stored once, whatever key it is stored under
+    const QString hash = HashOf(content);
+    if (!QFile::exists(FilePath(hash))) {
+        QSaveFile file(FilePath(hash));
+        if (!file.open(QIODevice::WriteOnly) || (file.write(content) != content.size()) || !file.commit()) {
+            return false;
+        }
+    }
+
+    QJsonObject index = ReadIndex();
+    QJsonObject entries = index.value(kEntriesStr).toObject();
+    const int use_count = index.value(kUseCountStr).toInt() + 1;
+
+    QJsonObject entry;
+    entry.insert(kHashStr, hash);
+    entry.insert(kSizeStr, content.size());
+    entry.insert(kLastUseStr, use_count);
+    entries.insert(key, entry);
+
+    Evict(entries);
+
+    index.insert(kUseCountStr, use_count);
+    index.insert(kEntriesStr, entries);
+
+    return WriteIndex(index);
+}
+
+QJsonObject FirmwareCache::ReadIndex() const {
+    QFile index_file(directory_.filePath(kIndexFileName));
+    if (!index_file.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
+    }
+
+    const QJsonObject index = QJsonDocument::fromJson(index_file.readAll()).object();
+    index_file.close();
+
+    return index;
+}
+
+bool FirmwareCache::WriteIndex(const QJsonObject& index) const {
+    // Index is replaced at once, so it is never left half written
+    QSaveFile index_file(directory_.filePath(kIndexFileName));
+    return index_file.open(QIODevice::WriteOnly) && (index_file.write(QJsonDocument(index).toJson()) >= 0) && index_file.commit();
+}
+
+QString FirmwareCache::FilePath(const QString& hash) const {
+    return directory_.filePath(hash + ".bin");
+}
+
+void FirmwareCache::RemoveFile(QJsonObject& entries, const QString& hash) const {
+    foreach (const QString& key, entries.keys()) {
+        if (entries.value(key).toObject().value(kHashStr).toString() == hash) {
+            entries.remove(key);
+        }
+    }
+
+    QFile::remove(FilePath(hash));
+}
+
+void FirmwareCache::Evict(QJsonObject& entries) const {
+    while (true) {
+        // File is used as recently as its most recently used key
+        QHash<QString, qint64> file_sizes;
+        QHash<QString, int> last_uses;
+        for (const auto& value : entries) {
+            const QJsonObject entry = value.toObject();
+            const QString hash = entry.value(kHashStr).toString();
+            file_sizes.insert(hash, SizeOf(entry));
+            last_uses.insert(hash, qMax(last_uses.value(hash, 0), entry.value(kLastUseStr).toInt()));
+        }
+
+        qint64 total_size = 0;
+        for (const qint64 size : file_sizes) {
+            total_size += size;
+        }
+
+        if (total_size <= max_size_) {
+            break;
+        }
+
+        QString least_recently_used;
+        for (auto it = last_uses.constBegin(); it != last_uses.constEnd(); ++it) {
+            if (least_recently_used.isEmpty() || (it.value() < last_uses.value(least_recently_used))) {
+                least_recently_used = it.key();
+            }
+        }
+
+        qInfo() << "Removing cached file " << least_recently_used;
+        RemoveFile(entries, least_recently_used);
+    }
+}
+
+} // namespace firmware_cache
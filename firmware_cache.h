@@ -0,0 +1,126 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef FIRMWARE_CACHE_H_
+#define FIRMWARE_CACHE_H_
+
+#include <QByteArray>
+#include <QDir>
+#include <QJsonObject>
+#include <QString>
+
+namespace firmware_cache {
+
+/*!
+ * \brief The FirmwareCache class, keeps downloaded firmware files on disk. Files are stored under the SHA-256 hash of
+ * their content and looked up by key, least recently used files are removed when the cache grows over its size limit.
+ */
+class FirmwareCache {
+
+  public:
+    /*!
+     * \brief FirmwareCache constructor
+     * \param directory - Cache directory, it is created when the first file is stored
+     * \param max_size - Max total size of cached files in bytes
+     */
+    FirmwareCache(const QString& directory, qint64 max_size);
+
+    /*!
+     * \brief Make key of the firmware file. Checksum announced with the file is part of the key, so a file that is
+     * republished under the same version is not taken from the cache.
+     * \param product_type - Product type of the board
+     * \param file_version - File version
+     * \param origin - Where the file comes from, e.g. URL or server
+     * \param file_checksum - Checksum of the file announced by its source
+     * \return Key of the firmware file
+     */
+    static QString MakeKey(const QString& product_type, const QString& file_version, const QString& origin, const QString& file_checksum);
+
+    /*!
+     * \brief Load cached file, its content is checked against the hash. File that does not match is removed.
+     * \param key - Key of the firmware file
+     * \param content - Loaded file content
+     * \return True if file is cached and intact, false otherwise
+     */
+    bool Load(const QString& key, QByteArray& content);
+
+    /*!
+     * \brief Store file to the cache, least recently used files are removed to make room for it
+     * \param key - Key of the firmware file
+     * \param content - File content
+     * \return True if file is stored, false if it is larger than the cache or it can not be written
+     */
+    bool Store(const QString& key, const QByteArray& content);
+
+  private:
+    /*!
+     * \brief Method used to read the cache index
+     * \return Index with cache entries
+     */
+    QJsonObject ReadIndex() const;
+
+    /*!
+     * \brief Method used to write the cache index
+     * \param index - Index with cache entries
+     * \return True if index is written, false otherwise
+     */
+    bool WriteIndex(const QJsonObject& index) const;
+
+    /*!
+     * \brief Method used to get path of the file with given content hash
+     * \param hash - Hex SHA-256 hash of the file content
+     * \return File path
+     */
+    QString FilePath(const QString& hash) const;
+
+    /*!
+     * \brief Method used to remove entries with given content hash and the file itself
+     * \param entries - Cache entries
+     * \param hash - Hex SHA-256 hash of the file content
+     */
+    void RemoveFile(QJsonObject& entries, const QString& hash) const;
+
+    /*!
+     * \brief Method used to remove least recently used files until cached files fit in max size
+     * \param entries - Cache entries
+     */
+    void Evict(QJsonObject& entries) const;
+
+    QDir directory_;    //!< Cache directory
+    qint64 max_size_;   //!< Max total size of cached files in bytes
+};
+
+} // namespace firmware_cache
+
+#endif // FIRMWARE_CACHE_H_
@@ -34,56 +34,62 @@
 
 #include "flasher.h"
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <QCoreApplication>
 #include <QDebug>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
 #include <QJsonDocument>
 #include <QMessageBox>
+#include <QVector>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
 
 #include "crc32.h"
+#include "frame.h"
 #include "socket_client.h"
 #include "file_downloader.h"
-#include "worker.h"
+#include "firmware_cache.h"
+#include "flasher_protocol.h"
 
 namespace flasher {
 namespace {
 
-constexpr qint64 kSignatureSize {64};
-constexpr int kEraseTimeoutInMs {5000};
-constexpr qint64 kPacketSize {256};
-constexpr qint64 kSecurePacketSize {296};
-constexpr unsigned long kThreadSleepTimeInMs {100U};
-constexpr int kSerialTimeoutInMs {100};
+constexpr int kPollPeriodInMs {100};     //!< Loop period of the states that wait for the board or a download
 constexpr int kCollectDataTimeoutInMs {300};
-constexpr int kCrc32Size {4};
 constexpr int kBoardIdSize {32};
 constexpr int kTryToConnectTimeoutInMs {20000};
 constexpr int kTryToDownloadFileTimeoutInMs {5000};
-
-// Commands
-constexpr char kVerifyFlasherCmd[] = "IMFlasher_Verify";
-constexpr char kEraseCmd[] = "erase";
-constexpr char kVersionCmd[] = "version";
-constexpr char kSoftwareInfoJsonCmd[] = "software_info_json";
-constexpr char kSecurityJsonCmd[] = "security_json";
-constexpr char kBoardIdCmd[] = "board_id";
-constexpr char kBoardInfoJsonCmd[] = "board_info_json";
-constexpr char kFlashFwCmd[] = "flash_fw";
-constexpr char kEnterBlCmd[] = "enter_bl";
-constexpr char kIsFwProtectedCmd[] = "is_fw_protected";
-constexpr char kEnableFwProtectionCmd[] = "enable_fw_protection";
-constexpr char kDisableFwProtectionCmd[] = "disable_fw_protection";
-constexpr char kExitBlCmd[] = "exit_bl";
-constexpr char kCheckSignatureCmd[] = "check_signature";
-constexpr char kDisconnectCmd[] = "disconnect";
+constexpr int kHotplugScanWindowInMs {1000};    //!< Ports are scanned for this long after hotplug event, board needs time to answer after enumeration
+constexpr int kFallbackScanPeriodInMs {2000};   //!< Period of the port scan outside of the hotplug window, board that is already attached sends no event
 
 constexpr char kFakeBoardIdBase64[] = "Tk9UX1NFQ1VSRURfTUFHSUNfU1RSSU5HXzEyMzQ1Njc="; // NOT_SECURED_MAGIC_STRING_1234567
 
 // Config
 constexpr char kConfigFileName[] = "config.json";
+constexpr char kPortCacheFileName[] = "port_cache.json";
+constexpr char kServerCacheFileName[] = "server_cache.json";
+constexpr char kServerRttsStr[] = "rtts";
+constexpr char kLegacyServersStr[] = "legacy_servers";
 constexpr uint32_t kConfigOpenAttempt = 2;
 constexpr char kConfigVersionStr[] = "config_version";
 constexpr char kEnableSignatureWarningStr[] = "enable_signature_warning";
+constexpr char kBaudRateStr[] = "baud_rate";
+constexpr char kHardwareFlowControlStr[] = "hardware_flow_control";
+constexpr char kUsbVendorIdsStr[] = "usb_vendor_ids";
+constexpr char kUsbProductIdsStr[] = "usb_product_ids";
+constexpr char kUsbManufacturerStr[] = "usb_manufacturer";
+constexpr char kFirmwareCacheSizeStr[] = "firmware_cache_size_mb";
+constexpr char kPipelinedDownloadStr[] = "pipelined_download";
+constexpr char kFirmwareCacheDirName[] = "firmware_cache";
+constexpr int kDefaultFirmwareCacheSizeInMb = 256;
+constexpr char kSerialBackendStr[] = "serial_backend";
+constexpr char kNativeSerialBackend[] = "native";
 
 // Servers default config
 constexpr char kDefaultServerAddress1[] = "server1.imtech.hr";
@@ -101,54 +107,256 @@ uint32_t Deserialize32(const uint8_t *buf) {
     return result;
 }
 
+void Serialize16(uint16_t value, uint8_t *buf) {
+    buf[0] = static_cast<uint8_t>(value >> 8U);
+    buf[1] = static_cast<uint8_t>(value >> 0U);
+}
+
+uint16_t Deserialize16(const uint8_t *buf) {
+    return static_cast<uint16_t>((buf[0] << 8U) | buf[1]);
+}
+
+// States that wait for the board or a download without any transition
+bool IsPollingState(FlasherStates state) {
+    return (state == FlasherStates::kTryToConnect) || (state == FlasherStates::kDownloadFileFromUrl) ||
+           (state == FlasherStates::kEnteringBootloader) || (state == FlasherStates::kExitingBootloader) ||
+           (state == FlasherStates::kReconnect);
+}
+
+std::mutex port_cache_mutex;    //!< Port cache file is shared by all flashers in the process
+
+// USB IDs are written as hex strings in configuration file, e.g. "0483"
+QVector<quint16> ToUsbIds(const QJsonArray& json_array) {
+    QVector<quint16> usb_ids;
+    for (const auto& value : json_array) {
+        bool is_valid = false;
+        const quint16 usb_id = value.toString().toUShort(&is_valid, 16);
+        if (is_valid) {
+            usb_ids.append(usb_id);
+        }
+    }
+
+    return usb_ids;
+}
+
+bool IsAckComplete(const communication::ByteView& rx_data) {
+    return rx_data.EqualsIgnoreCase("OK") || rx_data.EqualsIgnoreCase("NOK");
+}
+
+bool IsTrueComplete(const communication::ByteView& rx_data) {
+    return rx_data.EqualsIgnoreCase("TRUE") || rx_data.EqualsIgnoreCase("FALSE");
+}
+
+bool IsFrameComplete(const communication::ByteView& rx_data) {
+    int frame_size = 0;
+    return communication::PeekFrame(rx_data.data, rx_data.size, frame_size) != communication::FrameStatus::kIncomplete;
+}
+
+bool IsMessageWithCrcComplete(const communication::ByteView& rx_data) {
+    bool is_complete = false;
+
+    if (rx_data.size > kCrc32Size) {
+        const uint32_t data_size = rx_data.size - kCrc32Size;
+        const uint32_t crc = Deserialize32(reinterpret_cast<const uint8_t *>(rx_data.data + data_size));
+        is_complete = (crc == crc::CalculateCrc32(reinterpret_cast<const uint8_t *>(rx_data.data), data_size, false, false));
+    }
+
+    return is_complete;
+}
+
+// Server announces CRC and size of the file before it is requested, together they identify the file content
+QString ServerFileChecksum(qint64 file_size, quint32 file_crc) {
+    return QString("crc %1 size %2").arg(file_crc).arg(file_size);
+}
+
+QString MakeFirmwareCacheKey(const QString& origin, const QString& product_type, const QString& file_version, const QString& file_checksum) {
+    if (origin.isEmpty() || file_checksum.isEmpty()) {
+        return QString();
+    }
+
+    return firmware_cache::FirmwareCache::MakeKey(product_type, file_version, origin, file_checksum);
+}
+
+// Cached file is delivered to the stream at once, as if it was downloaded
+bool LoadStreamFromCache(ImageStream& image_stream, firmware_cache::FirmwareCache *firmware_cache, const QString& key) {
+    QByteArray file_content;
+    if (key.isEmpty() || !firmware_cache->Load(key, file_content)) {
+        return false;
+    }
+
+    if (!image_stream.SetSize(file_content.size()) || !image_stream.Append(file_content.constData(), file_content.size())) {
+        image_stream.Abort();
+    } else {
+        qInfo() << "File loaded from cache: " << key;
+    }
+
+    return true;
+}
+
+std::atomic<bool> is_gui_request_cancelled {false};     //!< Set while Flasher is destroyed, dialogs are not shown anymore
+
+// Dialogs can be shown only from the GUI thread, engine thread blocks until the dialog is closed. Request that is
+// cancelled returns default value, as if the dialog was dismissed.
+template <typename Function>
+auto RunOnGuiThread(Function function) -> decltype(function()) {
+    QCoreApplication *application = QCoreApplication::instance();
+    if ((application == nullptr) || (QThread::currentThread() == application->thread())) {
+        return function();
+    }
+
+    decltype(function()) result {};
+    QMetaObject::invokeMethod(application, [&result, &function]() {
+        if (!is_gui_request_cancelled) {
+            result = function();
+        }
+    }, Qt::BlockingQueuedConnection);
+    return result;
+}
+
 bool ShowInfoMsg(const QString& title, const QString& description) {
-    QMessageBox msg_box;
-    msg_box.setText(title);
-    msg_box.setInformativeText(description);
-    msg_box.setStandardButtons(QMessageBox::Ok | QMessageBox::Cancel);
-    return (msg_box.exec() == QMessageBox::Ok);
+    return RunOnGuiThread([&]() {
+        QMessageBox msg_box;
+        msg_box.setText(title);
+        msg_box.setInformativeText(description);
+        msg_box.setStandardButtons(QMessageBox::Ok | QMessageBox::Cancel);
+        return (msg_box.exec() == QMessageBox::Ok);
+    });
 }
 
 } // namespace
 
-Flasher::Flasher() = default;
+Flasher::Flasher() {
+    is_gui_request_cancelled = false;
+
+    // Members are children so they move to the engine thread together with the Flasher
+    serial_port_.setParent(this);
+    hotplug_watcher_.setParent(this);
+    loop_timer_.setParent(this);
+}
 
 Flasher::~Flasher() {
-    worker_thread_.quit();
-    worker_thread_.wait();
+    if (engine_thread_.isRunning()) {
+        QThread *destination_thread = QThread::currentThread();
+
+        // Engine objects are released on the engine thread, Flasher is handed back to be destroyed here
+        const auto release_engine = [this, destination_thread]() {
+            loop_timer_.stop();
+            hotplug_watcher_.Stop();
+            serial_port_.CloseConn();
+            StopImageDownload();
+            file_downloader_.reset();
+            socket_client_.reset();
+            moveToThread(destination_thread);
+        };
+
+        // Engine thread may wait for a dialog on this thread. Pending dialogs are skipped and GUI events are processed
+        // while engine shuts down, blocking call in both directions would deadlock.
+        is_gui_request_cancelled = true;
+        if (QCoreApplication::instance() != nullptr) {
+            QEventLoop shutdown_loop;
+            QMetaObject::invokeMethod(this, [&release_engine, &shutdown_loop]() {
+                release_engine();
+                QMetaObject::invokeMethod(&shutdown_loop, &QEventLoop::quit, Qt::QueuedConnection);
+            }, Qt::QueuedConnection);
+            shutdown_loop.exec(QEventLoop::ExcludeUserInputEvents);
+        } else {
+            // Without application engine thread shows no dialogs, nothing waits for this thread
+            QMetaObject::invokeMethod(this, release_engine, Qt::BlockingQueuedConnection);
+        }
+
+        engine_thread_.quit();
+        engine_thread_.wait();
+    } else {
+        StopImageDownload();
+    }
 }
 
 void Flasher::Init() {
+    moveToThread(&engine_thread_);
+    engine_thread_.start();
+    QMetaObject::invokeMethod(this, [this]() { InitEngine(); }, Qt::QueuedConnection);
+}
+
+void Flasher::InitEngine() {
     QJsonDocument json_document;
+    int firmware_cache_size_in_mb = kDefaultFirmwareCacheSizeInMb;
 
     if (OpenConfigFile(json_document)) {
         QJsonArray servers_array = json_document.object().find("servers")->toArray();
         socket_client_ = std::make_shared<socket::SocketClient>(std::move(servers_array));
+        LoadServerCache();
 
         if (0 == QString::compare("true", json_document.object().find(kEnableSignatureWarningStr)->toString(), Qt::CaseInsensitive)) {
             is_signature_warning_enabled_ = true;
         }
+
+        const QJsonObject config = json_document.object();
+        const bool is_hardware_flow_control_enabled = (0 == QString::compare("true", config.value(kHardwareFlowControlStr).toString(), Qt::CaseInsensitive));
+        serial_port_.SetLinkSettings(config.value(kBaudRateStr).toInt(communication::kHighBaudRate), is_hardware_flow_control_enabled);
+
+        communication::PortFilter port_filter;
+        port_filter.vendor_ids = ToUsbIds(config.value(kUsbVendorIdsStr).toArray());
+        port_filter.product_ids = ToUsbIds(config.value(kUsbProductIdsStr).toArray());
+        port_filter.manufacturer = config.value(kUsbManufacturerStr).toString();
+        serial_port_.SetPortFilter(port_filter);
+
+        if (0 == QString::compare(kNativeSerialBackend, config.value(kSerialBackendStr).toString(), Qt::CaseInsensitive)) {
+            serial_port_.SetBackend(communication::SerialBackend::kNative);
+        }
+
+        firmware_cache_size_in_mb = config.value(kFirmwareCacheSizeStr).toInt(kDefaultFirmwareCacheSizeInMb);
+        is_pipelined_download_enabled_ = (0 != QString::compare("false", config.value(kPipelinedDownloadStr).toString(), Qt::CaseInsensitive));
     }
 
+    firmware_cache_ = std::make_unique<firmware_cache::FirmwareCache>(kFirmwareCacheDirName, static_cast<qint64>(firmware_cache_size_in_mb) * 1024 * 1024);
+
+    LoadPortCache();
+
     file_downloader_ = std::make_unique<file_downloader::FileDownloader>();
     connect(file_downloader_.get(), &file_downloader::FileDownloader::Downloaded, this, &Flasher::FileDownloaded);
+    connect(file_downloader_.get(), &file_downloader::FileDownloader::ValidatorReceived, this, &Flasher::FileValidatorReceived);
     connect(file_downloader_.get(), &file_downloader::FileDownloader::DownloadProgress, this, &Flasher::DownloadProgress);
     connect(socket_client_.get(), &socket::SocketClient::DownloadProgress, this, &Flasher::DownloadProgress);
 
     connect(&serial_port_, &QSerialPort::errorOccurred, this, &Flasher::HandleSerialPortError);
 
-    Worker *worker = new Worker;
-    worker->moveToThread(&worker_thread_);
-    connect(&worker_thread_, &QThread::finished, worker, &QObject::deleteLater);
-    connect(this, &Flasher::RunLoop, worker, &Worker::DoWork);
-    connect(worker, &Worker::FlasherLoop, this, &Flasher::LoopHandler);
-    worker_thread_.start();
-    emit RunLoop();
+    connect(&hotplug_watcher_, &communication::HotplugWatcher::PortAdded, this, [this]() {
+        port_scan_timer_.start();
+        if (IsPollingState(state_)) {
+            loop_timer_.start(0);
+        }
+    });
+    hotplug_watcher_.Start();
+
+    loop_timer_.setSingleShot(true);
+    connect(&loop_timer_, &QTimer::timeout, this, &Flasher::LoopHandler);
 }
 
 void Flasher::FileDownloaded() {
-    is_download_success_ = file_downloader_->GetDownloadedData(file_content_);
+    QByteArray downloaded_data;
+    is_download_success_ = file_downloader_->GetDownloadedData(downloaded_data);
+    // Download of the cached file is aborted, its content is already loaded
+    if (is_file_cached_) {
+        is_download_success_ = true;
+    } else {
+        file_content_ = downloaded_data;
+    }
     is_file_downloaded_ = true;
+    if (IsPollingState(state_)) {
+        loop_timer_.start(0);
+    }
+}
+
+void Flasher::FileValidatorReceived(const QString& validator) {
+    if ((state_ != FlasherStates::kDownloadFileFromUrl) || is_file_cached_ || validator.isEmpty()) {
+        return;
+    }
+
+    file_checksum_ = validator;
+    if (LoadFileFromCache(file_checksum_)) {
+        is_file_cached_ = true;
+        file_downloader_->AbortDownload();
+    }
 }
 
 void Flasher::UpdateProgressBar(const quint64& sent_size, const quint64& total_size) {
@@ -164,6 +372,30 @@ void Flasher::UpdateProgressBar(const quint64& sent_size, const quint64& total_s
     }
 }
 
+uint16_t Flasher::WriteMessage(const char *data, qint64 length) {
+    const uint16_t sequence_number = tx_sequence_number_;
+
+    if (is_framing_enabled_) {
+        serial_port_.Write(communication::EncodeFrame(communication::FrameType::kRequest, sequence_number, data, static_cast<int>(length)));
+        ++tx_sequence_number_;
+    } else {
+        serial_port_.Write(data, length);
+    }
+
+    return sequence_number;
+}
+
+void Flasher::WriteWindowPacket(uint16_t sequence_number, const char *data, qint64 length) {
+    if (is_framing_enabled_) {
+        serial_port_.Write(communication::EncodeFrame(communication::FrameType::kRequest, sequence_number, data, static_cast<int>(length)));
+    } else {
+        uint8_t serialized_sequence_number[kSequenceNumberSize];
+        Serialize16(sequence_number, serialized_sequence_number);
+        serial_port_.Write(reinterpret_cast<const char *>(serialized_sequence_number), kSequenceNumberSize);
+        serial_port_.Write(data, length);
+    }
+}
+
 void Flasher::DownloadProgress(const qint64& bytes_received, const qint64& bytes_total) {
     UpdateProgressBar(bytes_received, bytes_total);
 }
@@ -182,10 +414,12 @@ void Flasher::LoopHandler() {
         case FlasherStates::kConnected:
             emit ClearTextInBrowser();
             emit ShowStatusMsg("Connected");
-            if (serial_port_.isOpen()) {
+            if (serial_port_.IsOpen()) {
                 emit SetButtons(is_bootloader_);
 
                 if (is_bootloader_) {
+                    is_framing_enabled_ = false;
+                    CollectBootloaderCapabilities();
                     GetVersionJson(bl_sw_info);
                     if (bl_sw_info.empty()) {
                         GetVersion();
@@ -212,7 +446,7 @@ void Flasher::LoopHandler() {
             bool is_disconnected_success = true;
             is_timer_started_ = false;
 
-            if (serial_port_.isOpen()) {
+            if (serial_port_.IsOpen()) {
                 if (is_bootloader_) {
                     qInfo() << "Send disconnect command";
                     is_disconnected_success = SendMessage(kDisconnectCmd, sizeof(kDisconnectCmd), kSerialTimeoutInMs);
@@ -250,6 +484,9 @@ void Flasher::LoopHandler() {
             break;
 
         case FlasherStates::kServerDataExchange:
+            // Socket client is handed back by the download thread
+            StopImageDownload();
+
             if (!board_info_.empty() && socket_client_) {
                 if (socket_client_->SendBoardInfo(board_info_, bl_sw_info, fw_sw_info)) {
                     if (socket_client_->ReceiveProductInfo(board_info_, bl_sw_info, product_info_, is_secure_communication_)) {
@@ -262,6 +499,8 @@ void Flasher::LoopHandler() {
                         emit ShowTextInBrowser("Bootloader variant is incompatible with the server!");
                     }
                 }
+
+                UpdateServerCache();
             }
             emit ClearStatusMsg();
 
@@ -269,10 +508,12 @@ void Flasher::LoopHandler() {
             break;
 
         case FlasherStates::kBrowseFile: {
-            QString file_path = QFileDialog::getOpenFileName(nullptr,
-                                                             tr("File binary"),
-                                                             "",
-                                                             tr("Binary (*.bin);;All Files (*)"));
+            QString file_path = RunOnGuiThread([]() {
+                return QFileDialog::getOpenFileName(nullptr,
+                                                    tr("File binary"),
+                                                    "",
+                                                    tr("Binary (*.bin);;All Files (*)"));
+            });
 
             if (!file_path.isEmpty()) {
                 if (OpenFile(file_path)) {
@@ -287,10 +528,28 @@ void Flasher::LoopHandler() {
 
         case FlasherStates::kLoadFile: {
             packet_size_ = kPacketSize;
+            StopImageDownload();
+            file_checksum_.clear();
+            is_file_cached_ = false;
+
             if (SetLocalFileContent()) {
                 // Local file
                 SetState(FlasherStates::kCheckSignature);
 
+            } else if (is_pipelined_download_enabled_ && ((file_source_ == "url") ||
+                       ((file_source_ == "server") && !is_secure_communication_ && !is_secure_bootloader_))) {
+                // Flashing starts as soon as file size is known, packets are sent as the file arrives
+                emit ShowStatusMsg("Downloading");
+
+                if (StartImageDownload()) {
+                    SetState(FlasherStates::kCheckSignature);
+                } else {
+                    StopImageDownload();
+                    emit ClearProgress();
+                    emit ShowStatusMsg("Download error");
+                    SetState(FlasherStates::kIdle);
+                }
+
             } else {
 
                 if (file_source_ == "url") {
@@ -305,7 +564,17 @@ void Flasher::LoopHandler() {
 
                     CollectSecurityDataFromBoard();
 
-                    if (socket_client_->DownloadFile(board_info_, client_security_data_, selected_file_version_, server_security_data_, file_content_)) {
+                    // File downloaded for previous board is taken from the cache once server announces its CRC
+                    const bool is_downloaded = socket_client_->DownloadFile(board_info_, client_security_data_, selected_file_version_, server_security_data_, file_content_,
+                                                                            [this](qint64 file_size, quint32 file_crc) {
+                        file_checksum_ = ServerFileChecksum(file_size, file_crc);
+                        is_file_cached_ = LoadFileFromCache(file_checksum_);
+                        return !is_file_cached_;
+                    });
+                    socket_client_->CloseSession(); // Server is not needed for the rest of the board interaction
+                    UpdateServerCache();
+
+                    if (is_downloaded) {
                         if (file_content_.isEmpty()) {
                             emit ClearProgress();
                             emit ShowStatusMsg("Download file error");
@@ -313,6 +582,9 @@ void Flasher::LoopHandler() {
                         } else {
 
                             if (client_security_data_.empty() || server_security_data_.empty()) {
+                                if (!is_file_cached_) {
+                                    StoreFileInCache();
+                                }
                                 SetState(FlasherStates::kCheckSignature);
                             } else {
                                 packet_size_ = kSecurePacketSize;
@@ -344,6 +616,9 @@ void Flasher::LoopHandler() {
                     emit ShowStatusMsg("Download error");
                     SetState(FlasherStates::kIdle);
                 } else {
+                    if (!is_file_cached_) {
+                        StoreFileInCache();
+                    }
                     SetState(FlasherStates::kCheckSignature);
                 }
 
@@ -500,7 +775,7 @@ void Flasher::LoopHandler() {
             emit DisableAllButtons();
             serial_port_.CloseConn();
 
-            if (!serial_port_.isOpen()) {
+            if (!serial_port_.IsOpen()) {
                 SetState(FlasherStates::kTryToConnect);
             }
 
@@ -539,21 +814,39 @@ void Flasher::LoopHandler() {
             break;
     }
 
-    worker_thread_.msleep(kThreadSleepTimeInMs);
-    emit RunLoop();
+    // Transitions are already scheduled by SetState(), only states that wait for something are polled
+    if (!loop_timer_.isActive() && IsPollingState(state_)) {
+        loop_timer_.start(kPollPeriodInMs);
+    }
 }
 
 FlashingInfo Flasher::Flash() {
+    crc::InitCrc32(image_crc_, false, false);
+
+    if (window_size_ > 1) {
+        return FlashWindowed();
+    }
+
     FlashingInfo flashing_info;
     const qint64 file_size = file_content_.size() - signature_size_;
     const qint64 num_of_packets = (file_size / packet_size_);
-    const char *data_file = file_content_.data() + signature_size_;
+    const char *data_file = file_content_.constData() + signature_size_;
+    qint64 total_round_trip_us = 0;
 
     // Send file in packages
     for (qint64 packet = 0; packet < num_of_packets; ++packet) {
         const char *data_position = data_file + (packet * packet_size_);
+        if (!WaitForImageData(signature_size_ + ((packet + 1) * packet_size_), kTryToDownloadFileTimeoutInMs)) {
+            flashing_info.success = false;
+            flashing_info.title = "Flashing process failed";
+            flashing_info.description = "Problem with download";
+            break;
+        }
+
         UpdateProgressBar((packet + 1U) * packet_size_, file_size);
-        flashing_info.success = SendMessage(data_position, packet_size_, kSerialTimeoutInMs);
+        crc::UpdateCrc32(image_crc_, reinterpret_cast<const uint8_t *>(data_position), packet_size_);
+        flashing_info.success = SendMessage(data_position, packet_size_, PacketAckTimeoutInMs(packet_size_));
+        total_round_trip_us += serial_port_.LastRoundTripUs();
 
         if (!flashing_info.success) {
             flashing_info.title = "Flashing process failed";
@@ -566,16 +859,102 @@ FlashingInfo Flasher::Flash() {
         const qint64 rest_size = file_size % packet_size_;
 
         if (rest_size > 0) {
-            UpdateProgressBar(num_of_packets * packet_size_ + rest_size, file_size);
-            flashing_info.success = SendMessage(data_file + (num_of_packets * packet_size_), rest_size, kSerialTimeoutInMs);
-
-            if (!flashing_info.success) {
+            const char *data_position = data_file + (num_of_packets * packet_size_);
+            if (WaitForImageData(signature_size_ + file_size, kTryToDownloadFileTimeoutInMs)) {
+                UpdateProgressBar(num_of_packets * packet_size_ + rest_size, file_size);
+                crc::UpdateCrc32(image_crc_, reinterpret_cast<const uint8_t *>(data_position), rest_size);
+                flashing_info.success = SendMessage(data_position, rest_size, PacketAckTimeoutInMs(rest_size));
+
+                if (!flashing_info.success) {
+                    flashing_info.title = "Flashing process failed";
+                    flashing_info.description = "Problem with flashing";
+                }
+            } else {
+                flashing_info.success = false;
                 flashing_info.title = "Flashing process failed";
-                flashing_info.description = "Problem with flashing";
+                flashing_info.description = "Problem with download";
             }
         }
     }
 
+    if (num_of_packets > 0) {
+        qInfo() << "Average packet round trip: " << (total_round_trip_us / num_of_packets) << "us";
+    }
+
+    return flashing_info;
+}
+
+FlashingInfo Flasher::FlashWindowed() {
+    FlashingInfo flashing_info;
+    const qint64 file_size = file_content_.size() - signature_size_;
+    const qint64 num_of_packets = (file_size + packet_size_ - 1) / packet_size_;
+    const char *data_file = file_content_.constData() + signature_size_;
+
+    QVector<bool> is_acked(num_of_packets, false);
+    qint64 base_packet = 0;     // Oldest packet that is not yet acknowledged
+    qint64 next_packet = 0;     // Next packet that will be sent
+    flashing_info.success = true;
+    serial_port_.ClearRxData();
+
+    while (flashing_info.success && (base_packet < num_of_packets)) {
+
+        // Fill the window with packets that are already downloaded, download is awaited only when nothing is in flight
+        while ((next_packet < num_of_packets) && ((next_packet - base_packet) < window_size_)) {
+            const qint64 offset = next_packet * packet_size_;
+            const qint64 length = qMin(packet_size_, file_size - offset);
+            const int timeout_ms = (next_packet == base_packet) ? kTryToDownloadFileTimeoutInMs : 0;
+            if (!WaitForImageData(signature_size_ + offset + length, timeout_ms)) {
+                break;
+            }
+
+            WriteWindowPacket(static_cast<uint16_t>(next_packet), data_file + offset, length);
+            crc::UpdateCrc32(image_crc_, reinterpret_cast<const uint8_t *>(data_file + offset), length);
+            ++next_packet;
+        }
+
+        if (next_packet == base_packet) {
+            qInfo() << "Download stalled at packet" << base_packet;
+            flashing_info.success = false;
+            break;
+        }
+
+        // Collect all ACKs that arrived so far, at least one
+        QVector<uint16_t> acked_sequence_numbers;
+        flashing_info.success = ReadWindowAcks(acked_sequence_numbers);
+        if (!flashing_info.success) {
+            qInfo() << "NO or NOK ACK for packet" << base_packet;
+            break;
+        }
+
+        for (int i = 0; flashing_info.success && (i < acked_sequence_numbers.size()); ++i) {
+            const uint16_t sequence_number = acked_sequence_numbers.at(i);
+
+            // Sequence numbers wrap, match the ACK against packets that are in flight
+            qint64 packet = base_packet;
+            while ((packet < next_packet) && (static_cast<uint16_t>(packet) != sequence_number)) {
+                ++packet;
+            }
+
+            if (packet == next_packet) {
+                qInfo() << "Unexpected ACK for packet" << sequence_number;
+                flashing_info.success = false;
+            } else {
+                is_acked[packet] = true;
+            }
+        }
+
+        while ((base_packet < num_of_packets) && is_acked.at(base_packet)) {
+            ++base_packet;
+        }
+
+        UpdateProgressBar(qMin(base_packet * packet_size_, file_size), file_size);
+    }
+
+    if (!flashing_info.success) {
+        flashing_info.title = "Flashing process failed";
+        flashing_info.description = "Problem with flashing";
+    }
+
     return flashing_info;
 }
 
@@ -591,15 +970,32 @@ FlashingInfo Flasher::CheckSignature() {
     return flashing_info;
 }
 
+bool Flasher::CheckAck(const communication::Frame& frame, uint16_t sequence_number) const {
+    bool success = false;
+
+    if (frame.sequence_number != sequence_number) {
+        qInfo() << "ERROR or TIMEOUT";
+    } else if (frame.type == communication::FrameType::kAck) {
+        qInfo() << "ACK";
+        success = true;
+    } else if (frame.type == communication::FrameType::kNak) {
+        qInfo() << "NOK ACK";
+    } else {
+        qInfo() << "ERROR or TIMEOUT";
+    }
+
+    return success;
+}
+
 bool Flasher::CheckAck() {
     bool success = false;
-    QByteArray data;
-    serial_port_.ReadData(data);
-    if (data.size() >= 2) {
-        if (0 == QString::compare("OK", data, Qt::CaseInsensitive)) {
+    // ACK is parsed in place, nothing is allocated per packet
+    const communication::ByteView data = serial_port_.PeekData();
+    if (data.size >= 2) {
+        if (data.EqualsIgnoreCase("OK")) {
             qInfo() << "ACK";
             success = true;
-        } else if (0 == QString::compare("NOK", data, Qt::CaseInsensitive)) {
+        } else if (data.EqualsIgnoreCase("NOK")) {
             qInfo() << "NOK ACK";
         } else {
             qInfo() << "ERROR or TIMEOUT";
@@ -607,20 +1003,19 @@ bool Flasher::CheckAck() {
     } else {
         qInfo() << "NO ACK";
     }
+    serial_port_.DiscardData(data.size);
 
     return success;
 }
 
-bool Flasher::CheckTrue() {
+bool Flasher::CheckTrue(const QByteArray& data) const {
     //TODO: better handling needed. For error false is returned
     bool success = false;
-    QByteArray data;
-    serial_port_.ReadData(data);
 
-    if (0 == QString::compare("TRUE", data, Qt::CaseInsensitive)) {
+    if (0 == data.compare("TRUE", Qt::CaseInsensitive)) {
         qInfo() << "TRUE";
         success = true;
-    } else if (0 == QString::compare("FALSE", data, Qt::CaseInsensitive)) {
+    } else if (0 == data.compare("FALSE", Qt::CaseInsensitive)) {
         qInfo() << "FALSE";
     } else {
         qInfo() << "ERROR or TIMEOUT";
@@ -631,11 +1026,29 @@ bool Flasher::CheckTrue() {
 
 FlashingInfo Flasher::CrcCheck() {
     FlashingInfo flashing_info;
+
+    // Streamed file is flashed before its download is verified, CRC is not sent for a file that is incomplete or damaged
+    if (image_stream_) {
+        if (!image_stream_->WaitForFinish(kTryToDownloadFileTimeoutInMs)) {
+            flashing_info.title = "Flashing process failed";
+            flashing_info.description = "Problem with download";
+            ReleaseFileContent();
+            return flashing_info;
+        }
+    }
+
     const qint64 file_size = file_content_.size() - signature_size_;
-    const char *data_file = file_content_.data() + signature_size_;
+    const char *data_file = file_content_.constData() + signature_size_;
+
+    // CRC is normally already calculated while packets were sent
+    uint32_t crc;
+    if (image_crc_.length == static_cast<uint64_t>(file_size)) {
+        crc = crc::FinalizeCrc32(image_crc_);
+    } else {
+        crc = crc::CalculateCrc32Parallel(reinterpret_cast<const uint8_t *>(data_file), file_size, false);
+    }
+    crc::InitCrc32(image_crc_, false, false);
 
-    const uint8_t *data = reinterpret_cast<const uint8_t *>(data_file);
-    uint32_t crc = crc::CalculateCrc32(data, file_size, false, false);
     QByteArray crc_data;
     crc_data.setNum(crc);
 
@@ -645,16 +1058,64 @@ FlashingInfo Flasher::CrcCheck() {
         flashing_info.title = "Flashing process done";
         flashing_info.description = "Successful flashing process";
 
+        // Image confirmed by the board is cached after the CRC, hashing and writing it does not delay the response
+        if (image_stream_) {
+            StoreFileInCache();
+        }
+
     } else {
         flashing_info.title = "Flashing process failed";
         flashing_info.description = "CRC problem";
     }
 
-    file_content_.clear();
+    ReleaseFileContent();
 
     return flashing_info;
 }
 
+bool Flasher::CollectBootloaderCapabilities() {
+    bool success = false;
+    window_size_ = 1;
+    max_packet_size_ = kPacketSize;
+    bl_capabilities_ = QJsonObject();
+
+    QByteArray out_data;
+    if (ReadMessageWithCrc(kCapabilitiesJsonCmd, sizeof(kCapabilitiesJsonCmd), kCapabilitiesTimeoutInMs, out_data)) {
+        bl_capabilities_ = QJsonDocument::fromJson(out_data).object();
+        success = !bl_capabilities_.empty();
+    }
+
+    if (success) {
+        const int window_size = qBound(1, bl_capabilities_.value("window_size").toInt(1), kMaxWindowSize);
+
+        if (window_size > 1) {
+            const QByteArray set_window_size_cmd = kSetWindowSizeCmd + QByteArray::number(window_size);
+            if (SendMessage(set_window_size_cmd.constData(), set_window_size_cmd.size() + 1, kSerialTimeoutInMs)) {
+                window_size_ = window_size;
+            }
+        }
+
+        if (!is_framing_enabled_ && bl_capabilities_.value("binary_framing").toBool(false)) {
+            if (SendMessage(kSetFramingBinaryCmd, sizeof(kSetFramingBinaryCmd), kSerialTimeoutInMs)) {
+                is_framing_enabled_ = true;
+                tx_sequence_number_ = 0U;
+            }
+        }
+
+        // Packets are kept aligned to the default packet size, bootloader writes flash in those units
+        const qint64 max_packet_size = bl_capabilities_.value("max_packet_size").toInt(kPacketSize);
+        max_packet_size_ = qBound(kPacketSize, (max_packet_size / kPacketSize) * kPacketSize, kMaxPacketSize);
+
+        qInfo() << "Window size: " << window_size_;
+        qInfo() << "Max packet size: " << max_packet_size_;
+        qInfo() << "Framing: " << (is_framing_enabled_ ? "binary" : "text");
+    } else {
+        qInfo() << "No capabilities from bootloader, using stop-and-wait transfer";
+    }
+
+    return success;
+}
+
 bool Flasher::CollectBoardId() {
     bool success = false;
 
@@ -664,6 +1125,7 @@ bool Flasher::CollectBoardId() {
         if (out_data.size() == kBoardIdSize) {
             board_id_ = out_data.toBase64();
             qInfo() << "Board ID: " << board_id_;
+            UpdatePortCache();
             success = true;
         }
     }
@@ -686,6 +1148,7 @@ bool Flasher::CollectBoardInfo() {
             board_id_ = board_info_.value("board_id").toString();
             qInfo() << "Board ID: " << board_id_;
             qInfo() << "manufacturer ID: " << board_info_.value("manufacturer_id").toString();
+            UpdatePortCache();
             success = true;
         }
     }
@@ -717,6 +1180,9 @@ bool Flasher::CollectSecurityDataFromBoard() {
 }
 
 FlashingInfo Flasher::ConsoleFlash() {
+    packet_size_ = kPacketSize;
+    CollectBootloaderCapabilities();
+
     FlashingInfo flashing_info = CheckSignature();
     if (!flashing_info.success) {
         return flashing_info;
@@ -765,10 +1231,10 @@ FlashingInfo Flasher::Erase() {
 }
 
 void Flasher::GetVersion() {
-    serial_port_.write(kVersionCmd, sizeof(kVersionCmd));
-    serial_port_.WaitForReadyRead(kSerialTimeoutInMs);
+    serial_port_.ClearRxData();
+    WriteMessage(kVersionCmd, sizeof(kVersionCmd));
     QByteArray data;
-    serial_port_.ReadData(data);
+    ReadResponse(data, kSerialTimeoutInMs, nullptr);
     emit ShowTextInBrowser(data);
 }
 
@@ -814,16 +1280,33 @@ bool Flasher::IsBootloaderDetected() const {
 
 bool Flasher::IsFirmwareProtected() {
     qInfo() << "Send is firmware protected command";
-    serial_port_.write(kIsFwProtectedCmd, sizeof(kIsFwProtectedCmd));
-    serial_port_.WaitForReadyRead(kSerialTimeoutInMs);
-    return CheckTrue();
+    serial_port_.ClearRxData();
+    WriteMessage(kIsFwProtectedCmd, sizeof(kIsFwProtectedCmd));
+    QByteArray data;
+    ReadResponse(data, kSerialTimeoutInMs, IsTrueComplete);
+    return CheckTrue(data);
 }
 
 bool Flasher::IsReadProtectionEnabled() const {
     return is_read_protection_enabled_;
 }
 
+bool Flasher::ConnectToPort(const QString& port_name) {
+    is_framing_enabled_ = false;
+    return serial_port_.OpenPort(port_name, is_bootloader_);
+}
+
+QString Flasher::GetBoardId() const {
+    return board_id_;
+}
+
+QByteArray Flasher::GetFileContent() const {
+    return file_content_;
+}
+
 bool Flasher::OpenFile(const QString& file_path) {
+    ReleaseFileContent();
+    file_to_flash_.close();
     file_to_flash_.setFileName(file_path);
 
     return file_to_flash_.open(QIODevice::ReadOnly);
@@ -869,8 +1352,16 @@ FlashingInfo Flasher::SendFileSize() {
 }
 
 bool Flasher::SendMessage(const char *data, qint64 length, int timeout_ms) {
-    serial_port_.write(data, length);
-    serial_port_.WaitForReadyRead(timeout_ms);
+    serial_port_.ClearRxData();
+
+    if (is_framing_enabled_) {
+        const uint16_t sequence_number = WriteMessage(data, length);
+        communication::Frame frame;
+        return ReadFrame(frame, timeout_ms) && CheckAck(frame, sequence_number);
+    }
+
+    serial_port_.Write(data, length);
+    serial_port_.WaitForReadyRead(timeout_ms, IsAckComplete);
     return CheckAck();
 }
 
@@ -893,7 +1384,13 @@ FlashingInfo Flasher::SendSignature() {
     FlashingInfo flashing_info;
     signature_size_ = kSignatureSize;
 
-    flashing_info.success = SendMessage(file_content_.data(), kSignatureSize, kSerialTimeoutInMs);
+    if (!WaitForImageData(qMin<qint64>(kSignatureSize, file_content_.size()), kTryToDownloadFileTimeoutInMs)) {
+        flashing_info.title = "Flashing process failed";
+        flashing_info.description = "Problem with download";
+        return flashing_info;
+    }
+
+    flashing_info.success = SendMessage(file_content_.constData(), kSignatureSize, kSerialTimeoutInMs);
     if (!flashing_info.success) {
 
         bool continue_without_signature = true;
@@ -921,12 +1418,23 @@ bool Flasher::ReadMessageWithCrc(const char *in_data, qint64 length, int timeout
     QElapsedTimer timer;
     timer.start();
 
-    if (serial_port_.isOpen()) {
-        serial_port_.write(in_data, length);
+    if (serial_port_.IsOpen()) {
+        serial_port_.ClearRxData();
+        WriteMessage(in_data, length);
+
+        // Frame CRC already protects the payload, there is no additional CRC inside of it
+        if (is_framing_enabled_) {
+            communication::Frame frame;
+            success = ReadFrame(frame, timeout_ms) && (frame.type == communication::FrameType::kResponse);
+            if (success) {
+                out_data = frame.payload;
+            }
+            return success;
+        }
 
         QByteArray data;
 
-        serial_port_.WaitForReadyRead(timeout_ms);
+        serial_port_.WaitForReadyRead(timeout_ms, IsMessageWithCrcComplete);
         serial_port_.ReadData(data);
         QByteArray data_crc = data.right(kCrc32Size);
 
@@ -946,6 +1454,66 @@ bool Flasher::ReadMessageWithCrc(const char *in_data, qint64 length, int timeout
     return success;
 }
 
+bool Flasher::ReadFrame(communication::Frame& frame, int timeout_ms) {
+    serial_port_.WaitForReadyRead(timeout_ms, IsFrameComplete);
+
+    int frame_size = 0;
+    const communication::ByteView rx_data = serial_port_.PeekData();
+    const bool success = (communication::DecodeFrame(rx_data.data, rx_data.size, frame, frame_size) == communication::FrameStatus::kComplete);
+    serial_port_.ClearRxData();
+
+    return success;
+}
+
+void Flasher::ReadResponse(QByteArray& out_data, int timeout_ms, const communication::SerialPort::CompletionCheck& is_complete) {
+    if (is_framing_enabled_) {
+        communication::Frame frame;
+        if (ReadFrame(frame, timeout_ms) && (frame.type == communication::FrameType::kResponse)) {
+            out_data = frame.payload;
+        } else {
+            out_data.clear();
+        }
+    } else {
+        serial_port_.WaitForReadyRead(timeout_ms, is_complete);
+        serial_port_.ReadData(out_data);
+    }
+}
+
+bool Flasher::ReadWindowAcks(QVector<uint16_t>& sequence_numbers) {
+    bool success = true;
+
+    if (is_framing_enabled_) {
+        serial_port_.WaitForReadyRead(PacketAckTimeoutInMs(packet_size_), IsFrameComplete);
+
+        communication::Frame frame;
+        int frame_size = 0;
+        communication::ByteView rx_data = serial_port_.PeekData();
+        while (success && (communication::DecodeFrame(rx_data.data, rx_data.size, frame, frame_size) == communication::FrameStatus::kComplete)) {
+            serial_port_.DiscardData(frame_size);
+            rx_data = serial_port_.PeekData();
+            success = (frame.type == communication::FrameType::kAck);
+            sequence_numbers.append(frame.sequence_number);
+        }
+
+        success = success && !sequence_numbers.isEmpty();
+
+    } else {
+        success = serial_port_.WaitForBytes(kWindowAckSize, PacketAckTimeoutInMs(packet_size_));
+
+        const communication::ByteView acks = serial_port_.PeekData();
+        const int acks_size = success ? ((acks.size / kWindowAckSize) * kWindowAckSize) : 0;
+
+        for (int i = 0; success && (i < acks_size); i += kWindowAckSize) {
+            const uint8_t *ack = reinterpret_cast<const uint8_t *>(acks.data + i);
+            success = (0 == memcmp(ack, kWindowAckOk, 2));
+            sequence_numbers.append(Deserialize16(ack + 2));
+        }
+        serial_port_.DiscardData(acks_size);
+    }
+
+    return success;
+}
+
 bool Flasher::SendEnterBootloaderCommand() {
     qInfo() << "Send enter bl command";
     return SendMessage(kEnterBlCmd, sizeof(kEnterBlCmd), kSerialTimeoutInMs);
@@ -953,25 +1521,87 @@ bool Flasher::SendEnterBootloaderCommand() {
 
 void Flasher::SendFlashCommand() {
     qInfo() << "Send flash command";
-    serial_port_.write(kFlashFwCmd, sizeof(kFlashFwCmd));
-    serial_port_.WaitForReadyRead(kSerialTimeoutInMs);
+    serial_port_.ClearRxData();
+    WriteMessage(kFlashFwCmd, sizeof(kFlashFwCmd));
+    QByteArray data;
+    ReadResponse(data, kSerialTimeoutInMs, nullptr);
     // Check ack
 }
 
+void Flasher::SetFileContent(const QByteArray& file_content) {
+    file_content_ = file_content;
+}
+
 bool Flasher::SetLocalFileContent() {
-    if (file_to_flash_.isOpen()) {
-        file_content_ = file_to_flash_.readAll();
-        file_to_flash_.close();
+    if (file_to_flash_.isOpen() && (mapped_file_ == nullptr)) {
+        const qint64 file_size = file_to_flash_.size();
+        mapped_file_ = (file_size > 0) ? file_to_flash_.map(0, file_size) : nullptr;
+
+        if (mapped_file_ != nullptr) {
+#ifdef Q_OS_UNIX
+            // Image is read front to back, let the kernel read ahead
+            posix_madvise(mapped_file_, static_cast<size_t>(file_size), POSIX_MADV_SEQUENTIAL);
+#endif
+            file_content_ = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped_file_), static_cast<int>(file_size));
+        } else {
+            // Files that cannot be mapped, e.g. empty files or some network shares, are read into memory
+            file_content_ = file_to_flash_.readAll();
+            file_to_flash_.close();
+        }
         return true;
     }
     return false;
 }
 
+void Flasher::ReleaseFileContent() {
+    // View of the mapped file is dropped before the file is unmapped
+    file_content_.clear();
+
+    if (mapped_file_ != nullptr) {
+        file_to_flash_.unmap(mapped_file_);
+        file_to_flash_.close();
+        mapped_file_ = nullptr;
+    }
+
+    StopImageDownload();
+}
+
 void Flasher::SetState(const FlasherStates& state) {
+    // Command from the GUI thread is queued to the engine thread
+    if (QThread::currentThread() != thread()) {
+        QElapsedTimer latency_timer;
+        latency_timer.start();
+        QMetaObject::invokeMethod(this, [this, state, latency_timer]() {
+            qInfo() << "GUI to engine latency: " << (latency_timer.nsecsElapsed() / 1000) << "us";
+            SetState(state);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // Mapping of the local file is held only while flashing, file replaced after a failed attempt is read again
+    if ((state == FlasherStates::kIdle) || (state == FlasherStates::kError)) {
+        ReleaseFileContent();
+    }
+
     state_ = state;
+    loop_timer_.start(0);
+}
+
+void Flasher::SetDownloadSources(std::shared_ptr<socket::SocketClient> socket_client, std::unique_ptr<firmware_cache::FirmwareCache> firmware_cache) {
+    socket_client_ = std::move(socket_client);
+    firmware_cache_ = std::move(firmware_cache);
+}
+
+void Flasher::SetBoardInfo(const QJsonObject& board_info) {
+    board_info_ = board_info;
 }
 
 void Flasher::SetSelectedFileVersion(const QString& selected_file_version) {
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, selected_file_version]() { SetSelectedFileVersion(selected_file_version); }, Qt::QueuedConnection);
+        return;
+    }
+
     selected_file_version_ = selected_file_version;
 
     foreach (const QJsonValue& value, product_info_) {
@@ -983,10 +1613,12 @@ void Flasher::SetSelectedFileVersion(const QString& selected_file_version) {
 }
 
 void Flasher::TryToConnectConsole() {
+    LoadPortCache();
+
     QElapsedTimer timer;
     timer.start();
 
-    while (!serial_port_.isOpen()) {
+    while (!serial_port_.IsOpen()) {
         serial_port_.TryOpenPort(is_bootloader_);
 
         if (timer.hasExpired(kTryToConnectTimeoutInMs)) {
@@ -994,6 +1626,8 @@ void Flasher::TryToConnectConsole() {
             break;
         }
     }
+
+    is_framing_enabled_ = false;
 }
 
 void Flasher::TryToConnect() {
@@ -1001,7 +1635,12 @@ void Flasher::TryToConnect() {
 
     if (is_timer_started_) {
 
-        if (serial_port_.TryOpenPort(is_bootloader_)) {
+        const bool is_port_scan_needed = IsPortScanNeeded();
+        if (is_port_scan_needed) {
+            last_port_scan_timer_.start();
+        }
+
+        if (is_port_scan_needed && serial_port_.TryOpenPort(is_bootloader_)) {
             emit EnableDisconnectButton();
             SetState(FlasherStates::kConnected);
             is_timer_started_ = false;
@@ -1019,20 +1658,241 @@ void Flasher::TryToConnect() {
         emit DisableAllButtons();
         is_timer_started_ = true;
         timer_.start();
+        port_scan_timer_.start();
+        last_port_scan_timer_.invalidate();
     }
 }
 
+bool Flasher::IsPortScanNeeded() const {
+    // Without hotplug events ports are scanned on every loop, otherwise after a port is added and slowly in case an event is missed
+    return !hotplug_watcher_.IsActive() || (port_scan_timer_.isValid() && !port_scan_timer_.hasExpired(kHotplugScanWindowInMs)) ||
+           !last_port_scan_timer_.isValid() || last_port_scan_timer_.hasExpired(kFallbackScanPeriodInMs);
+}
+
 void Flasher::DownloadFileFromUrl() {
+    const QString file_url = SelectedFileUrl();
+    if (!file_url.isEmpty()) {
+        timer_.start();
+        file_downloader_->StartDownload(QUrl(file_url));
+    }
+}
+
+QString Flasher::SelectedFileUrl() const {
+    return SelectedFileInfo().value("url").toString();
+}
+
+QJsonObject Flasher::SelectedFileInfo() const {
     foreach (const QJsonValue& value, product_info_) {
         QJsonObject obj = value.toObject();
         if (obj["file_version"].toString() == selected_file_version_) {
+            return obj;
+        }
+    }
 
-            QUrl file_url(obj["url"].toString());
-            timer_.start();
-            file_downloader_->StartDownload(file_url);
-            break;
+    return QJsonObject();
+}
+
+bool Flasher::StartImageDownload() {
+    StopImageDownload();
+
+    image_stream_ = std::make_unique<ImageStream>();
+    ImageStream *image_stream = image_stream_.get();
+    const auto handle_file_size = [image_stream](qint64 file_size) {
+        if (!image_stream->SetSize(file_size)) {
+            image_stream->Abort();
         }
+    };
+    const auto consume_chunk = [image_stream](const char *chunk, int size) {
+        return image_stream->Append(chunk, size);
+    };
+    const auto handle_pending_data = [image_stream](qint64 size) {
+        image_stream->ReportReceived(size);
+    };
+
+    // Cache is checked in the download thread as soon as the file is identified, cached file is not downloaded
+    firmware_cache::FirmwareCache *firmware_cache = firmware_cache_.get();
+    const QString cache_origin = FirmwareCacheOrigin();
+    const QString product_type = board_info_.value("product_type").toString();
+    const QString file_version = selected_file_version_;
+    const auto handle_file_checksum = [=](const QString& file_checksum) {
+        if (LoadStreamFromCache(*image_stream, firmware_cache, MakeFirmwareCacheKey(cache_origin, product_type, file_version, file_checksum))) {
+            return false;
+        }
+
+        image_stream->SetChecksum(file_checksum);
+        return true;
+    };
+
+    if (file_source_ == "server") {
+        // Socket client moves to the download thread and it is handed back when the download is done
+        std::shared_ptr<socket::SocketClient> socket_client = socket_client_;
+        QThread *socket_thread = socket_client->thread();
+        const QJsonObject board_info = board_info_;
+        const auto handle_file_header = [=](qint64 file_size, quint32 file_crc) {
+            if (!handle_file_checksum(ServerFileChecksum(file_size, file_crc))) {
+                return false;
+            }
+
+            handle_file_size(file_size);
+            return true;
+        };
+
+        // Download progress would arrive only after flashing is done, flashing progress is shown instead
+        socket_client->blockSignals(true);
+        download_thread_.reset(QThread::create([=]() {
+            QJsonObject server_security_data;
+            const bool success = socket_client->DownloadFileStream(board_info, QJsonObject(), file_version, server_security_data, consume_chunk, handle_file_header);
+            socket_client->CloseSession();
+            socket_client->moveToThread(socket_thread);
+            image_stream->Finish(success && server_security_data.isEmpty());
+        }));
+        socket_client->moveToThread(download_thread_.get());
+
+    } else {
+        const QUrl file_url(SelectedFileUrl());
+        download_thread_.reset(QThread::create([=]() {
+            file_downloader::FileDownloader file_downloader;
+            image_stream->Finish(file_downloader.DownloadStream(file_url, handle_file_size, consume_chunk, handle_pending_data, handle_file_checksum));
+        }));
     }
+
+    download_thread_->start();
+
+    if (!image_stream_->WaitForSize(kTryToDownloadFileTimeoutInMs)) {
+        return false;
+    }
+
+    file_content_ = image_stream_->Content();
+    return true;
+}
+
+void Flasher::StopImageDownload() {
+    if (!image_stream_) {
+        return;
+    }
+
+    image_stream_->Abort();
+    if (download_thread_) {
+        download_thread_->wait();
+        download_thread_.reset();
+    }
+
+    if (socket_client_) {
+        socket_client_->blockSignals(false);
+        UpdateServerCache();
+    }
+
+    // View of the streamed file is dropped before the file itself
+    if (file_content_.constData() == image_stream_->Content().constData()) {
+        file_content_.clear();
+    }
+    image_stream_.reset();
+}
+
+bool Flasher::WaitForImageData(qint64 size, int timeout_ms) {
+    return !image_stream_ || image_stream_->WaitForData(size, timeout_ms);
+}
+
+bool Flasher::LoadFileFromCache(const QString& file_checksum) {
+    const QString key = FirmwareCacheKey(file_checksum);
+    if (key.isEmpty() || !firmware_cache_->Load(key, file_content_)) {
+        return false;
+    }
+
+    qInfo() << "File loaded from cache: " << key;
+    emit ShowTextInBrowser("File " + selected_file_version_ + " loaded from cache");
+    return true;
+}
+
+void Flasher::StoreFileInCache() {
+    const QString key = FirmwareCacheKey(image_stream_ ? image_stream_->Checksum() : file_checksum_);
+    if (!key.isEmpty()) {
+        firmware_cache_->Store(key, file_content_);
+    }
+}
+
+QString Flasher::FirmwareCacheOrigin() const {
+    // Secure server files are encrypted for each board, they can not be reused
+    if (!firmware_cache_ || selected_file_version_.isEmpty() || ((file_source_ == "server") && is_secure_communication_)) {
+        return QString();
+    }
+
+    if (file_source_ == "url") {
+        return SelectedFileUrl();
+    } else if (file_source_ == "server") {
+        return file_source_;
+    }
+
+    return QString();
+}
+
+QString Flasher::FirmwareCacheKey(const QString& file_checksum) const {
+    return MakeFirmwareCacheKey(FirmwareCacheOrigin(), board_info_.value("product_type").toString(), selected_file_version_, file_checksum);
+}
+
+int Flasher::PacketAckTimeoutInMs(qint64 length) const {
+    // Large packets take a noticeable part of the timeout on the wire, e.g. 8 KiB needs ~710 ms at 115200
+    return kSerialTimeoutInMs + serial_port_.TransferTimeInMs(length);
+}
+
+void Flasher::NegotiatePacketSize() {
+    // Secure packets are encrypted by the server with a fixed size, only plain transfer can use bigger packets
+    if ((packet_size_ == kPacketSize) && (max_packet_size_ > kPacketSize)) {
+        const QByteArray set_packet_size_cmd = kSetPacketSizeCmd + QByteArray::number(max_packet_size_);
+        if (SendMessage(set_packet_size_cmd.constData(), set_packet_size_cmd.size() + 1, kSerialTimeoutInMs)) {
+            packet_size_ = max_packet_size_;
+        }
+    }
+
+    qInfo() << "Packet size: " << packet_size_;
+    emit ShowTextInBrowser("Packet size: " + QString::number(packet_size_));
+}
+
+void Flasher::LoadPortCache() {
+    QFile cache_file(kPortCacheFileName);
+    if (!cache_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QJsonObject cache = QJsonDocument::fromJson(cache_file.readAll()).object();
+    cache_file.close();
+
+    QVector<communication::PortIdentity> preferred_ports;
+    for (const auto& value : cache) {
+        const QJsonObject port = value.toObject();
+        communication::PortIdentity port_identity;
+        port_identity.serial_number = port.value("serial_number").toString();
+        port_identity.system_location = port.value("system_location").toString();
+        port_identity.vendor_id = static_cast<quint16>(port.value("vendor_id").toInt());
+        port_identity.product_id = static_cast<quint16>(port.value("product_id").toInt());
+        preferred_ports.append(port_identity);
+    }
+
+    serial_port_.SetPreferredPorts(preferred_ports);
+}
+
+void Flasher::LoadServerCache() {
+    QFile cache_file(kServerCacheFileName);
+    if (!cache_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QJsonObject cache = QJsonDocument::fromJson(cache_file.readAll()).object();
+    cache_file.close();
+
+    QHash<QString, int> server_rtts;
+    const QJsonObject rtts = cache.value(kServerRttsStr).toObject();
+    for (auto it = rtts.constBegin(); it != rtts.constEnd(); ++it) {
+        server_rtts.insert(it.key(), it.value().toInt());
+    }
+
+    QSet<QString> legacy_servers;
+    foreach (const QJsonValue& value, cache.value(kLegacyServersStr).toArray()) {
+        legacy_servers.insert(value.toString());
+    }
+
+    socket_client_->SetServerRtts(server_rtts);
+    socket_client_->SetLegacyServers(legacy_servers);
 }
 
 bool Flasher::OpenConfigFile(QJsonDocument& json_document) {
@@ -1079,6 +1939,13 @@ void Flasher::CreateDefaultConfigFile() {
 
         json_object.insert(kConfigVersionStr, json_object_version);
         json_object.insert(kEnableSignatureWarningStr, "true");
+        json_object.insert(kBaudRateStr, communication::kHighBaudRate);
+        json_object.insert(kHardwareFlowControlStr, "false");
+        json_object.insert(kUsbVendorIdsStr, QJsonArray());
+        json_object.insert(kUsbProductIdsStr, QJsonArray());
+        json_object.insert(kUsbManufacturerStr, "");
+        json_object.insert(kFirmwareCacheSizeStr, kDefaultFirmwareCacheSizeInMb);
+        json_object.insert(kPipelinedDownloadStr, "true");
 
         QJsonObject json_object_server_1;
         QJsonObject json_object_server_2;
@@ -1108,6 +1975,56 @@ void Flasher::CreateDefaultConfigFile() {
     }
 }
 
+void Flasher::UpdatePortCache() {
+    std::lock_guard<std::mutex> lock(port_cache_mutex);
+    QFile cache_file(kPortCacheFileName);
+    QJsonObject cache;
+    if (cache_file.open(QIODevice::ReadOnly)) {
+        cache = QJsonDocument::fromJson(cache_file.readAll()).object();
+        cache_file.close();
+    }
+
+    const communication::PortIdentity port_identity = serial_port_.LastPortIdentity();
+    QJsonObject port;
+    port.insert("serial_number", port_identity.serial_number);
+    port.insert("system_location", port_identity.system_location);
+    port.insert("vendor_id", port_identity.vendor_id);
+    port.insert("product_id", port_identity.product_id);
+
+    // Rewrite the cache only when the board moved to a different port
+    if (cache.value(board_id_).toObject() != port) {
+        cache.insert(board_id_, port);
+        if (cache_file.open(QIODevice::WriteOnly)) {
+            cache_file.write(QJsonDocument(cache).toJson());
+            cache_file.close();
+        }
+    }
+}
+
+void Flasher::UpdateServerCache() {
+    QJsonObject rtts;
+    const QHash<QString, int> server_rtts = socket_client_->ServerRtts();
+    for (auto it = server_rtts.constBegin(); it != server_rtts.constEnd(); ++it) {
+        rtts.insert(it.key(), it.value());
+    }
+
+    // Servers without framing support are remembered, so their connection is not dropped by the capability request
+    QJsonArray legacy_servers;
+    foreach (const QString& server_key, socket_client_->LegacyServers()) {
+        legacy_servers.append(server_key);
+    }
+
+    QJsonObject cache;
+    cache.insert(kServerRttsStr, rtts);
+    cache.insert(kLegacyServersStr, legacy_servers);
+
+    QFile cache_file(kServerCacheFileName);
+    if (cache_file.open(QIODevice::WriteOnly)) {
+        cache_file.write(QJsonDocument(cache).toJson());
+        cache_file.close();
+    }
+}
+
 FlashingInfo Flasher::VerifyFlasher() {
     FlashingInfo flashing_info;
     flashing_info.success = SendMessage(kVerifyFlasherCmd, sizeof(kVerifyFlasherCmd), kSerialTimeoutInMs);
@@ -1115,6 +2032,8 @@ FlashingInfo Flasher::VerifyFlasher() {
     if (!flashing_info.success) {
         flashing_info.title = "Flashing process failed";
         flashing_info.description = "Verify flasher problem";
+    } else {
+        NegotiatePacketSize();
     }
 
     return flashing_info;
@@ -40,8 +40,14 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QThread>
+#include <QTimer>
+#include <QVector>
 
+#include "crc32.h"
 #include "flasher_states.h"
+#include "frame.h"
+#include "hotplug_watcher.h"
+#include "image_stream.h"
 #include "flashing_info.h"
 #include "serial_port.h"
 
@@ -57,6 +63,12 @@ class FileDownloader;
 
 } // namespace file_downloader
 
+namespace firmware_cache {
+
+class FirmwareCache;
+
+} // namespace firmware_cache
+
 namespace flasher {
 
 /*!
@@ -95,6 +107,13 @@ class Flasher : public QObject {
      */
     bool CollectSecurityDataFromBoard();
 
+    /*!
+     * \brief Method used to connect to the board on the given port, used from the console
+     * \param port_name - Port name
+     * \return True if board is connected, false otherwise
+     */
+    bool ConnectToPort(const QString& port_name);
+
     /*!
      * \brief Method used to flash from the console
      * \return Flashing information
@@ -108,7 +127,21 @@ class Flasher : public QObject {
     FlashingInfo Erase();
 
     /*!
-     * \brief Flasher initialization
+     * \brief Get board ID, valid after board ID or board info is collected
+     * \return Board ID
+     */
+    QString GetBoardId() const;
+
+    /*!
+     * \brief Get file content, implicitly shared so several flashers can use one image without a copy. Local file content
+     * is a view of the mapped file, valid until the flashing is done or another file is opened.
+     * \return File content
+     */
+    QByteArray GetFileContent() const;
+
+    /*!
+     * \brief Flasher initialization for the GUI. Flasher, serial port and socket client are moved to the engine thread,
+     * GUI talks to them only through queued SetState()/SetSelectedFileVersion() calls and signals.
      */
     void Init();
 
@@ -143,19 +176,91 @@ class Flasher : public QObject {
     void SendFlashCommand();
 
     /*!
-     * \brief Set local file content
+     * \brief Set file content that will be flashed
+     * \param file_content - File content
+     */
+    void SetFileContent(const QByteArray& file_content);
+
+    /*!
+     * \brief Set local file content. File is mapped read-only and its pages are read as they are sent, so flashing
+     * starts without reading the whole file first. File stays open until the flashing is done or fails, mapping is
+     * released whenever flasher goes back to idle or error state. File must not be rewritten or truncated while it
+     * is flashed, access to the part that is cut off from a mapped file is terminated by SIGBUS.
      * \return True if local file content is successully set, false otherwise
      */
     bool SetLocalFileContent();
 
     /*!
-     * \brief Set flasher state
+     * \brief Set file content from the firmware cache, so file that is already downloaded is not downloaded again
+     * \param file_checksum - Checksum announced by the file source before the file content
+     * \return True if selected file version with given checksum is cached, false otherwise
+     */
+    bool LoadFileFromCache(const QString& file_checksum);
+
+    /*!
+     * \brief Store downloaded file content to the firmware cache, under the checksum announced by its source
+     */
+    void StoreFileInCache();
+
+    /*!
+     * \brief Get firmware cache key of the selected file version
+     * \param file_checksum - Server file CRC and size, or ETag/Last-Modified of the file URL
+     * \return Cache key, empty if file can not be cached
+     */
+    QString FirmwareCacheKey(const QString& file_checksum) const;
+
+    /*!
+     * \brief Set sources of the downloaded files, they are otherwise created from the configuration file by Init()
+     * \param socket_client - Socket client used for the server
+     * \param firmware_cache - Firmware cache
+     */
+    void SetDownloadSources(std::shared_ptr<socket::SocketClient> socket_client, std::unique_ptr<firmware_cache::FirmwareCache> firmware_cache);
+
+    /*!
+     * \brief Set board information, it is otherwise collected from the connected board
+     * \param board_info - Board information
+     */
+    void SetBoardInfo(const QJsonObject& board_info);
+
+    /*!
+     * \brief Start download of the selected file in its own thread, so it can be flashed while it arrives
+     * \return True if file size is known and file content is set, false otherwise
+     */
+    bool StartImageDownload();
+
+    /*!
+     * \brief Stop download started by StartImageDownload and release the streamed image
+     */
+    void StopImageDownload();
+
+    /*!
+     * \brief Wait until first size bytes of the file content arrive, file that is not streamed is always complete
+     * \param size - Number of bytes from the start of the file
+     * \param timeout_ms - Max time in [ms] without new data
+     * \return True if data is here, false if download failed or stalled
+     */
+    bool WaitForImageData(qint64 size, int timeout_ms);
+
+    /*!
+     * \brief Get URL of the selected file version
+     * \return File URL, empty if selected version has no URL
+     */
+    QString SelectedFileUrl() const;
+
+    /*!
+     * \brief Get product information of the selected file version
+     * \return Product information entry, empty if selected version is not listed
+     */
+    QJsonObject SelectedFileInfo() const;
+
+    /*!
+     * \brief Set flasher state, safe to call from any thread
      * \param state - Flasher state that will be set
      */
     void SetState(const FlasherStates& state);
 
     /*!
-     * \brief Set selected file version
+     * \brief Set selected file version, safe to call from any thread
      * \param selected_file_version - File version that will be set
      */
     void SetSelectedFileVersion(const QString& selected_file_version);
@@ -200,11 +305,6 @@ class Flasher : public QObject {
      */
     void FailedToConnect();
 
-    /*!
-     * \brief RunLoop signal
-     */
-    void RunLoop();
-
     /*!
      * \brief Show text in browser signal
      * \param text - Text that will be displayed
@@ -270,6 +370,12 @@ class Flasher : public QObject {
      */
     void FileDownloaded();
 
+    /*!
+     * \brief FileValidatorReceived slot, download of the file that is already cached is aborted
+     * \param validator - ETag or Last-Modified of the downloaded file
+     */
+    void FileValidatorReceived(const QString& validator);
+
     /*!
      * \brief DownloadProgress slot
      * \param bytes_received - Number of received bytes
@@ -290,6 +396,7 @@ class Flasher : public QObject {
     QJsonObject server_security_data_;                                      //!< Security data server
     QJsonObject bl_sw_info;                                                 //!< Bootloader software info
     QJsonObject fw_sw_info;                                                 //!< Firmware software info
+    QJsonObject bl_capabilities_;                                           //!< Bootloader capabilities
     QJsonArray product_info_;                                               //!< Product information
     QString selected_file_version_;                                         //!< Selected file version
     QString file_source_;                                                   //!< File source (URL or Server)
@@ -297,6 +404,10 @@ class Flasher : public QObject {
     QFile file_to_flash_;                                                   //!< File to flash
     qint64 signature_size_{0};                                              //!< Signature size
     qint64 packet_size_{0};                                                 //!< Size of the packets that will be used to send data for flashing
+    qint64 max_packet_size_{0};                                             //!< Max packet size supported by the bootloader
+    int window_size_{1};                                                    //!< Number of packets in flight, 1 for stop-and-wait
+    uint16_t tx_sequence_number_{0U};                                       //!< Sequence number of the next framed request
+    bool is_framing_enabled_{false};                                        //!< Is binary framing negotiated with the bootloader
     quint8 last_progress_percentage_{0};                                    //!< Last progress percentage
     bool is_bootloader_ {false};                                            //!< Is bootloader detected flag
     bool is_bootloader_expected_ {false};                                   //!< Is bootloader expected after board reset
@@ -307,13 +418,25 @@ class Flasher : public QObject {
     bool is_signature_warning_enabled_{false};                              //!< Is signature warning enabled
     bool is_secure_communication_{false};                                   //!< Is communication with the server secure
     bool is_secure_bootloader_{false};                                      //!< Is secure bootloader variant
-    QByteArray file_content_;                                               //!< File content
+    bool is_file_cached_{false};                                            //!< Is file content loaded from the firmware cache
+    QString file_checksum_;                                                 //!< Checksum announced by the source of the downloaded file
+    QByteArray file_content_;                                               //!< File content, view of mapped_file_ for local files
+    uchar *mapped_file_{nullptr};                                           //!< Mapping of the local file, null if not mapped
+    crc::Crc32Context image_crc_;                                           //!< CRC of the image, updated while packets are sent
     communication::SerialPort serial_port_;                                 //!< Serial port object
     std::shared_ptr<socket::SocketClient> socket_client_;                   //!< Shared pointer to SocketClient object
     std::unique_ptr<file_downloader::FileDownloader> file_downloader_;      //!< Pointer to FileDownloader object
+    std::unique_ptr<firmware_cache::FirmwareCache> firmware_cache_;         //!< Pointer to FirmwareCache object
+    std::unique_ptr<ImageStream> image_stream_;                             //!< File that is flashed while it downloads, null otherwise
+    std::unique_ptr<QThread> download_thread_;                              //!< Thread that downloads image_stream_
+    bool is_pipelined_download_enabled_{true};                              //!< Downloaded file is flashed while it arrives
     FlasherStates state_ {FlasherStates::kIdle};                            //!< Flasher state
     QElapsedTimer timer_;                                                   //!< Timer
-    QThread worker_thread_;                                                 //!< Worker thread
+    QElapsedTimer port_scan_timer_;                                         //!< Time since last added port or start of the connection attempt
+    QElapsedTimer last_port_scan_timer_;                                    //!< Time since ports were last scanned
+    communication::HotplugWatcher hotplug_watcher_;                         //!< Serial port hotplug watcher
+    QTimer loop_timer_;                                                     //!< Single shot timer that runs LoopHandler
+    QThread engine_thread_;                                                 //!< Thread that runs flashing engine in the GUI
 
     /*!
      * \brief Method is used to check if acknowledge is received from bootloader side
@@ -321,6 +444,14 @@ class Flasher : public QObject {
      */
     bool CheckAck();
 
+    /*!
+     * \brief Method is used to check if framed acknowledge is received for the given request
+     * \param frame - Received frame
+     * \param sequence_number - Sequence number of the request
+     * \return True if ACK frame with matching sequence number is received, false otherwise
+     */
+    bool CheckAck(const communication::Frame& frame, uint16_t sequence_number) const;
+
     /*!
      * \brief Method used to check signature
      * \return Flashing info structure
@@ -329,9 +460,17 @@ class Flasher : public QObject {
 
     /*!
      * \brief CheckTrue
+     * \param data - Received answer
      * \return True if TRUE is received, false otherwise
      */
-    bool CheckTrue();
+    bool CheckTrue(const QByteArray& data) const;
+
+    /*!
+     * \brief Method used to collect bootloader capabilities. Bootloaders that do not support capabilities command are
+     * treated as plain stop-and-wait bootloaders.
+     * \return True if capabilities are successfully collected, false otherwise
+     */
+    bool CollectBootloaderCapabilities();
 
     /*!
      * \brief Method used to check CRC
@@ -349,12 +488,24 @@ class Flasher : public QObject {
      */
     void DownloadFileFromUrl();
 
+    /*!
+     * \brief Method used to get origin of the selected file version in the firmware cache
+     * \return File URL or "server", empty if file can not be cached
+     */
+    QString FirmwareCacheOrigin() const;
+
     /*!
      * \brief Method used to perform flash process
      * \return Flashing info structure
      */
     FlashingInfo Flash();
 
+    /*!
+     * \brief Method used to perform flash process with several sequence-numbered packets in flight
+     * \return Flashing info structure
+     */
+    FlashingInfo FlashWindowed();
+
     /*!
      * \brief Method used to get version of bootloader/firmware
      */
@@ -367,12 +518,48 @@ class Flasher : public QObject {
      */
     bool GetVersionJson(QJsonObject& out_json_object);
 
+    /*!
+     * \brief Method used to read configuration and create engine objects, runs on the engine thread
+     */
+    void InitEngine();
+
     /*!
      * \brief Method used to check if firmware is protected or not
      * \return True if firmware is protected, false otherwise
      */
     bool IsFirmwareProtected();
 
+    /*!
+     * \brief Method used to check if ports should be scanned for the board while trying to connect
+     * \return True if scan is needed, false otherwise
+     */
+    bool IsPortScanNeeded() const;
+
+    /*!
+     * \brief Method used to load ports where known boards were found in previous sessions, they are probed first
+     */
+    void LoadPortCache();
+
+    /*!
+     * \brief Method used to load server connect times measured in previous sessions, faster servers are tried first.
+     * Servers that do not support framing are loaded as well.
+     */
+    void LoadServerCache();
+
+    /*!
+     * \brief Method used to switch to the largest packet size supported by both sides. Bootloader is asked to accept it
+     * and default packet size stays in use if it refuses.
+     */
+    void NegotiatePacketSize();
+
+    /*!
+     * \brief Method used to get ACK timeout of a data packet, transfer time of the packet is added to the bootloader
+     * response time
+     * \param length - Packet length
+     * \return Timeout in [ms]
+     */
+    int PacketAckTimeoutInMs(qint64 length) const;
+
     /*!
      * \brief Method used to open configuration file
      * \param json_document - Json document where configuration file is saved
@@ -380,6 +567,29 @@ class Flasher : public QObject {
      */
     bool OpenConfigFile(QJsonDocument& json_document);
 
+    /*!
+     * \brief Method used to read one binary frame, rest of the received data is discarded
+     * \param frame - Decoded frame
+     * \param timeout_ms - Timeout in [ms]
+     * \return True if complete and valid frame is received, false otherwise
+     */
+    bool ReadFrame(communication::Frame& frame, int timeout_ms);
+
+    /*!
+     * \brief Method used to read response to a request, payload of the response frame if binary framing is enabled
+     * \param out_data - Response
+     * \param timeout_ms - Timeout in [ms]
+     * \param is_complete - Function that checks if text response is complete, may be empty
+     */
+    void ReadResponse(QByteArray& out_data, int timeout_ms, const communication::SerialPort::CompletionCheck& is_complete);
+
+    /*!
+     * \brief Method used to read all window ACKs that arrived so far, at least one
+     * \param sequence_numbers - Sequence numbers of acknowledged packets
+     * \return True if only positive ACKs are received, false on NOK ACK, invalid data or timeout
+     */
+    bool ReadWindowAcks(QVector<uint16_t>& sequence_numbers);
+
     /*!
      * \brief Method used to read message with CRC
      * \param in_data - Pointer to the input data
@@ -395,6 +605,11 @@ class Flasher : public QObject {
      */
     void ReconnectingToBoard();
 
+    /*!
+     * \brief Method used to clear file content and release the mapped local file
+     */
+    void ReleaseFileContent();
+
     /*!
      * \brief Method used to send file size to the bootloader
      * \return Flashing info structure
@@ -432,6 +647,32 @@ class Flasher : public QObject {
      * \brief Method used to try to connect to the board
      */
     void TryToConnect();
+
+    /*!
+     * \brief Method used to store port of the connected board to the port cache, keyed by board ID
+     */
+    void UpdatePortCache();
+
+    /*!
+     * \brief Method used to store server connect times and servers without framing support to the server cache
+     */
+    void UpdateServerCache();
+
+    /*!
+     * \brief Method used to write request, wrapped in a frame with the next sequence number if binary framing is enabled
+     * \param data - Pointer to data that will be sent
+     * \param length - Data length
+     * \return Sequence number of the request
+     */
+    uint16_t WriteMessage(const char *data, qint64 length);
+
+    /*!
+     * \brief Method used to write one sequence-numbered packet of the windowed transfer
+     * \param sequence_number - Packet sequence number
+     * \param data - Pointer to packet data
+     * \param length - Packet length
+     */
+    void WriteWindowPacket(uint16_t sequence_number, const char *data, qint64 length);
 };
 
 } // namespace flasher
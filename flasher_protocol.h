@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef FLASHER_PROTOCOL_H_
+#define FLASHER_PROTOCOL_H_
+
+#include <QtGlobal>
+
+namespace flasher {
+
+// Transfer
+constexpr qint64 kSignatureSize {64};
+constexpr qint64 kPacketSize {256};
+constexpr qint64 kSecurePacketSize {296};
+constexpr qint64 kMaxPacketSize {8192};
+constexpr int kSerialTimeoutInMs {100};
+constexpr int kEraseTimeoutInMs {5000};
+constexpr int kCapabilitiesTimeoutInMs {50};    //!< Capabilities answer is short, older bootloaders do not answer it at all
+constexpr int kCrc32Size {4};
+constexpr int kMaxWindowSize {32};
+constexpr int kSequenceNumberSize {2};
+constexpr int kWindowAckSize {4};       //!< Windowed ACK: 2 byte status ("OK" or "NK") followed by 2 byte sequence number
+
+// Commands
+constexpr char kVerifyFlasherCmd[] = "IMFlasher_Verify";
+constexpr char kEraseCmd[] = "erase";
+constexpr char kVersionCmd[] = "version";
+constexpr char kSoftwareInfoJsonCmd[] = "software_info_json";
+constexpr char kSecurityJsonCmd[] = "security_json";
+constexpr char kBoardIdCmd[] = "board_id";
+constexpr char kBoardInfoJsonCmd[] = "board_info_json";
+constexpr char kFlashFwCmd[] = "flash_fw";
+constexpr char kEnterBlCmd[] = "enter_bl";
+constexpr char kIsFwProtectedCmd[] = "is_fw_protected";
+constexpr char kEnableFwProtectionCmd[] = "enable_fw_protection";
+constexpr char kDisableFwProtectionCmd[] = "disable_fw_protection";
+constexpr char kExitBlCmd[] = "exit_bl";
+constexpr char kCheckSignatureCmd[] = "check_signature";
+constexpr char kDisconnectCmd[] = "disconnect";
+constexpr char kCapabilitiesJsonCmd[] = "capabilities_json";
+constexpr char kSetWindowSizeCmd[] = "set_window_size ";
+constexpr char kWindowAckOk[] = "OK";
+constexpr char kSetFramingBinaryCmd[] = "set_framing_binary";
+constexpr char kSetPacketSizeCmd[] = "set_packet_size ";
+
+} // namespace flasher
+
+#endif // FLASHER_PROTOCOL_H_
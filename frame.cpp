@@ -0,0 +1,157 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "frame.h"
+
+#include <algorithm>
+
+#include "crc32.h"
+
+namespace communication {
+namespace {
+
+constexpr int kTypeOffset {1};
+constexpr int kSequenceNumberOffset {2};
+constexpr int kLengthOffset {4};
+
+uint16_t Deserialize16(const char *buf) {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(buf);
+    return static_cast<uint16_t>((data[0] << 8U) | data[1]);
+}
+
+uint32_t Deserialize32(const char *buf) {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(buf);
+    uint32_t result;
+    result = static_cast<uint32_t>(data[0] << 24U);
+    result |= static_cast<uint32_t>(data[1] << 16U);
+    result |= static_cast<uint32_t>(data[2] << 8U);
+    result |= static_cast<uint32_t>(data[3] << 0U);
+    return result;
+}
+
+void Serialize16(uint16_t value, char *buf) {
+    buf[0] = static_cast<char>(value >> 8U);
+    buf[1] = static_cast<char>(value >> 0U);
+}
+
+void Serialize32(uint32_t value, char *buf) {
+    buf[0] = static_cast<char>(value >> 24U);
+    buf[1] = static_cast<char>(value >> 16U);
+    buf[2] = static_cast<char>(value >> 8U);
+    buf[3] = static_cast<char>(value >> 0U);
+}
+
+bool IsValidType(uint8_t type) {
+    return (type == static_cast<uint8_t>(FrameType::kRequest)) || (type == static_cast<uint8_t>(FrameType::kResponse)) ||
+           (type == static_cast<uint8_t>(FrameType::kAck)) || (type == static_cast<uint8_t>(FrameType::kNak));
+}
+
+} // namespace
+
+QByteArray EncodeFrame(FrameType type, uint16_t sequence_number, const char *payload, int length) {
+    // Longer payload would be sent with a truncated length field
+    if ((length < 0) || (length > kMaxFramePayloadSize)) {
+        return QByteArray();
+    }
+
+    QByteArray frame(kFrameHeaderSize + length + kFrameCrcSize, Qt::Uninitialized);
+    char *data = frame.data();
+
+    data[0] = static_cast<char>(kFrameStartByte);
+    data[kTypeOffset] = static_cast<char>(type);
+    Serialize16(sequence_number, data + kSequenceNumberOffset);
+    Serialize16(static_cast<uint16_t>(length), data + kLengthOffset);
+    std::copy(payload, payload + length, data + kFrameHeaderSize);
+
+    const uint32_t crc = crc::CalculateCrc32(reinterpret_cast<const uint8_t *>(data), kFrameHeaderSize + length, false, false);
+    Serialize32(crc, data + kFrameHeaderSize + length);
+
+    return frame;
+}
+
+FrameStatus PeekFrame(const QByteArray& data, int& frame_size) {
+    return PeekFrame(data.constData(), data.size(), frame_size);
+}
+
+FrameStatus PeekFrame(const char *data, int size, int& frame_size) {
+    if (size <= 0) {
+        return FrameStatus::kIncomplete;
+    }
+
+    if ((static_cast<uint8_t>(data[0]) != kFrameStartByte) || ((size > kTypeOffset) && !IsValidType(static_cast<uint8_t>(data[kTypeOffset])))) {
+        return FrameStatus::kInvalid;
+    }
+
+    if (size < kFrameHeaderSize) {
+        return FrameStatus::kIncomplete;
+    }
+
+    const int length = Deserialize16(data + kLengthOffset);
+    if (size < (kFrameHeaderSize + length + kFrameCrcSize)) {
+        return FrameStatus::kIncomplete;
+    }
+
+    const uint32_t crc = Deserialize32(data + kFrameHeaderSize + length);
+    if (crc != crc::CalculateCrc32(reinterpret_cast<const uint8_t *>(data), kFrameHeaderSize + length, false, false)) {
+        return FrameStatus::kInvalid;
+    }
+
+    frame_size = kFrameHeaderSize + length + kFrameCrcSize;
+
+    return FrameStatus::kComplete;
+}
+
+FrameStatus DecodeFrame(const QByteArray& data, Frame& frame, int& frame_size) {
+    return DecodeFrame(data.constData(), data.size(), frame, frame_size);
+}
+
+FrameStatus DecodeFrame(const char *data, int size, Frame& frame, int& frame_size) {
+    const FrameStatus status = PeekFrame(data, size, frame_size);
+
+    if (status == FrameStatus::kComplete) {
+        const int payload_size = frame_size - kFrameHeaderSize - kFrameCrcSize;
+        frame.type = static_cast<FrameType>(data[kTypeOffset]);
+        frame.sequence_number = Deserialize16(data + kSequenceNumberOffset);
+        // ACK and NAK have no payload, nothing is allocated for them
+        if (payload_size > 0) {
+            frame.payload = QByteArray(data + kFrameHeaderSize, payload_size);
+        } else {
+            frame.payload.clear();
+        }
+    }
+
+    return status;
+}
+
+} // namespace communication
@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <cstdint>
+#include <QByteArray>
+
+namespace communication {
+
+constexpr uint8_t kFrameStartByte {0xA5U};     //!< First byte of every frame
+constexpr int kFrameHeaderSize {6};             //!< Start byte, type, 2 byte sequence number, 2 byte payload length
+constexpr int kFrameCrcSize {4};                //!< CRC32 of header and payload
+constexpr int kMaxFramePayloadSize {0xFFFF};    //!< Max payload size that fits into the length field
+
+/*!
+ * \brief The FrameType enum, type byte of the binary frame
+ */
+enum class FrameType : uint8_t {
+    kRequest = 0x01,    //!< Command or data from host to board
+    kResponse = 0x02,   //!< Data from board to host
+    kAck = 0x06,        //!< Request accepted
+    kNak = 0x15         //!< Request rejected
+};
+
+/*!
+ * \brief The FrameStatus enum, result of frame parsing
+ */
+enum class FrameStatus {
+    kIncomplete,        //!< More data is needed
+    kComplete,          //!< Complete and valid frame
+    kInvalid            //!< Data does not start with a valid frame
+};
+
+/*!
+ * \brief The Frame struct, decoded binary frame
+ */
+struct Frame {
+    FrameType type {FrameType::kNak};   //!< Frame type
+    uint16_t sequence_number {0U};      //!< Sequence number, ACK and NAK carry the number of the request
+    QByteArray payload;                 //!< Frame payload
+};
+
+/*!
+ * \brief Encode binary frame: header (start byte, type, sequence number, length), payload and CRC32, big-endian
+ * \param type - Frame type
+ * \param sequence_number - Sequence number
+ * \param payload - Pointer to payload
+ * \param length - Payload length, at most kMaxFramePayloadSize
+ * \return Encoded frame, empty if payload is too long
+ */
+QByteArray EncodeFrame(FrameType type, uint16_t sequence_number, const char *payload, int length);
+
+/*!
+ * \brief Check if data starts with a complete frame, without decoding it
+ * \param data - Received data
+ * \param frame_size - Size of the frame including header and CRC, valid if kComplete is returned
+ * \return Frame status
+ */
+FrameStatus PeekFrame(const QByteArray& data, int& frame_size);
+
+/*!
+ * \brief Check if data starts with a complete frame, without decoding it
+ * \param data - Pointer to received data, e.g. view of the Rx buffer
+ * \param size - Size of received data
+ * \param frame_size - Size of the frame including header and CRC, valid if kComplete is returned
+ * \return Frame status
+ */
+FrameStatus PeekFrame(const char *data, int size, int& frame_size);
+
+/*!
+ * \brief Decode frame from the beginning of data
+ * \param data - Received data
+ * \param frame - Decoded frame, valid if kComplete is returned
+ * \param frame_size - Size of the frame including header and CRC, valid if kComplete is returned
+ * \return Frame status
+ */
+FrameStatus DecodeFrame(const QByteArray& data, Frame& frame, int& frame_size);
+
+/*!
+ * \brief Decode frame from the beginning of data
+ * \param data - Pointer to received data, e.g. view of the Rx buffer
+ * \param size - Size of received data
+ * \param frame - Decoded frame, valid if kComplete is returned
+ * \param frame_size - Size of the frame including header and CRC, valid if kComplete is returned
+ * \return Frame status
+ */
+FrameStatus DecodeFrame(const char *data, int size, Frame& frame, int& frame_size);
+
+} // namespace communication
+#endif // FRAME_H_
@@ -0,0 +1,172 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "gang_flasher.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QSerialPort>
+
+#include "async_flash_session.h"
+#include "flasher.h"
+#include "serial_port.h"
+
+namespace flasher {
+
+GangFlasher::GangFlasher(const QByteArray& file_content) :
+    file_content_(file_content) {
+}
+
+GangFlasher::~GangFlasher() = default;
+
+QVector<GangResult> GangFlasher::FlashAll() const {
+    const QStringList port_names = communication::SerialPort().FindBoardPorts();
+    qInfo() << "Boards detected on: " << port_names;
+
+    // Each thread writes only its own result
+    QVector<GangResult> results(port_names.size());
+    std::vector<std::thread> sessions;
+    sessions.reserve(port_names.size());
+
+    for (int i = 0; i < port_names.size(); ++i) {
+        sessions.emplace_back([this, &results, &port_names, i]() {
+            results[i] = FlashBoard(port_names.at(i));
+        });
+    }
+
+    for (auto& session : sessions) {
+        session.join();
+    }
+
+    return results;
+}
+
+QVector<GangResult> GangFlasher::FlashAllAsync() const {
+    const QStringList port_names = communication::SerialPort().FindBoardPorts();
+    qInfo() << "Boards detected on: " << port_names;
+
+    QVector<GangResult> results(port_names.size());
+    std::vector<std::unique_ptr<QSerialPort>> ports;
+    std::vector<std::unique_ptr<AsyncFlashSession>> sessions;
+    std::vector<QElapsedTimer> timers(port_names.size());
+    QEventLoop event_loop;
+    int running_sessions = 0;
+
+    for (int i = 0; i < port_names.size(); ++i) {
+        results[i].port_name = port_names.at(i);
+        timers[i].start();
+
+        ports.push_back(std::make_unique<QSerialPort>());
+        if (!communication::OpenDefaultPort(*ports.back(), port_names.at(i))) {
+            results[i].flashing_info.description = "Connect error";
+            continue;
+        }
+
+        sessions.push_back(std::make_unique<AsyncFlashSession>(*ports.back(), file_content_));
+        AsyncFlashSession *session = sessions.back().get();
+
+        QObject::connect(session, &AsyncFlashSession::Progress, [&port_names, i](const qint8& progress_percentage) {
+            qInfo() << port_names.at(i) << ": " << progress_percentage << "%";
+        });
+        QObject::connect(session, &AsyncFlashSession::Finished, [&, session, i]() {
+            results[i].flashing_info = session->GetFlashingInfo();
+            results[i].elapsed_ms = timers[i].elapsed();
+            if (--running_sessions == 0) {
+                event_loop.quit();
+            }
+        });
+
+        ++running_sessions;
+        session->Start();
+    }
+
+    // All sessions run on this thread, driven by serial port and timeout events
+    if (running_sessions > 0) {
+        event_loop.exec();
+    }
+
+    return results;
+}
+
+GangResult GangFlasher::FlashBoard(const QString& port_name) const {
+    GangResult result;
+    result.port_name = port_name;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Flasher flasher;
+    QObject::connect(&flasher, &Flasher::UpdateProgressBarSignal, [&port_name](const qint8& progress_percentage) {
+        qInfo() << port_name << ": " << progress_percentage << "%";
+    });
+
+    if (!flasher.ConnectToPort(port_name)) {
+        result.flashing_info.description = "Connect error";
+    } else if (!flasher.IsBootloaderDetected()) {
+        result.flashing_info.description = "Bootloader not detected, enter bootloader first";
+    } else if (!flasher.CollectBoardId()) {
+        result.flashing_info.description = "Board ID error";
+    } else {
+        result.board_id = flasher.GetBoardId();
+        flasher.SetFileContent(file_content_);
+        result.flashing_info = flasher.ConsoleFlash();
+    }
+
+    result.elapsed_ms = timer.elapsed();
+
+    return result;
+}
+
+bool GangFlasher::PrintSummary(const QVector<GangResult>& results, qint64 elapsed_ms) {
+    int success_count = 0;
+
+    qInfo() << "Summary:";
+    for (const GangResult& result : results) {
+        qInfo() << result.port_name << result.board_id << (result.flashing_info.success ? "OK" : "FAILED")
+                << result.flashing_info.description << result.elapsed_ms << "ms";
+        if (result.flashing_info.success) {
+            ++success_count;
+        }
+    }
+
+    qInfo() << success_count << "/" << results.size() << "boards flashed in" << elapsed_ms << "ms";
+
+    return !results.isEmpty() && (success_count == results.size());
+}
+
+} // namespace flasher
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef GANG_FLASHER_H_
+#define GANG_FLASHER_H_
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "flashing_info.h"
+
+namespace flasher {
+
+/*!
+ * \brief The GangResult struct, result of flashing one board
+ */
+struct GangResult {
+    QString port_name;                  //!< Port where board is connected
+    QString board_id;                   //!< Board ID, empty if it could not be collected
+    FlashingInfo flashing_info;         //!< Flashing information
+    qint64 elapsed_ms {0};              //!< Time spent on the board in [ms]
+};
+
+/*!
+ * \brief The GangFlasher class, flashes one image to all detected boards in parallel. Every board gets its own Flasher
+ * on its own thread, all of them share the same implicitly shared image.
+ */
+class GangFlasher {
+
+  public:
+    /*!
+     * \brief GangFlasher constructor
+     * \param file_content - Image that will be flashed to all boards
+     */
+    explicit GangFlasher(const QByteArray& file_content);
+
+    /*!
+     * \brief GangFlasher destructor
+     */
+    ~GangFlasher();
+
+    /*!
+     * \brief Flash all detected boards, returns when the slowest board is done
+     * \return Results sorted by port name
+     */
+    QVector<GangResult> FlashAll() const;
+
+    /*!
+     * \brief Flash all detected boards from the current thread, each board is driven by an AsyncFlashSession. Needs
+     * QCoreApplication, returns when the slowest board is done.
+     * \return Results sorted by port name, board ID is not collected
+     */
+    QVector<GangResult> FlashAllAsync() const;
+
+    /*!
+     * \brief Print per-board summary to the console
+     * \param results - Results of FlashAll()
+     * \param elapsed_ms - Total time in [ms]
+     * \return True if all boards are successfully flashed, false otherwise
+     */
+    static bool PrintSummary(const QVector<GangResult>& results, qint64 elapsed_ms);
+
+  private:
+    /*!
+     * \brief Method used to flash board on the given port
+     * \param port_name - Port name
+     * \return Result for the board
+     */
+    GangResult FlashBoard(const QString& port_name) const;
+
+    const QByteArray file_content_;     //!< Image shared by all boards
+};
+
+} // namespace flasher
+#endif // GANG_FLASHER_H_
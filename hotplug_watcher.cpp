@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "hotplug_watcher.h"
+
+#include <QDebug>
+#include <QList>
+
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace communication {
+namespace {
+
+constexpr int kUeventBufferSize {8192};
+constexpr char kTtySubsystem[] = "tty";
+constexpr char kVirtualDevPath[] = "/devices/virtual/";   //!< Consoles and pseudo terminals, never a board
+
+} // namespace
+
+HotplugWatcher::HotplugWatcher() = default;
+
+HotplugWatcher::~HotplugWatcher() {
+    Stop();
+}
+
+bool HotplugWatcher::Start() {
+#ifdef Q_OS_LINUX
+    if (socket_fd_ >= 0) {
+        return true;
+    }
+
+    socket_fd_ = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (socket_fd_ < 0) {
+        qInfo() << "Hotplug watcher not available";
+        return false;
+    }
+
+    sockaddr_nl address {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1U;     // Kernel uevent group
+
+    if (bind(socket_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        qInfo() << "Hotplug watcher not available";
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+
+    // Notifier is a child, so it follows the watcher when it is moved to another thread
+    socket_notifier_ = std::make_unique<QSocketNotifier>(socket_fd_, QSocketNotifier::Read, this);
+    connect(socket_notifier_.get(), &QSocketNotifier::activated, this, &HotplugWatcher::ReadUevents);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HotplugWatcher::Stop() {
+    socket_notifier_.reset();
+#ifdef Q_OS_LINUX
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+#endif
+}
+
+bool HotplugWatcher::IsActive() const {
+    return socket_fd_ >= 0;
+}
+
+void HotplugWatcher::InjectUevent(const QByteArray& uevent) {
+    HandleUevent(uevent);
+}
+
+void HotplugWatcher::ReadUevents() {
+#ifdef Q_OS_LINUX
+    char buffer[kUeventBufferSize];
+    ssize_t size;
+
+    while ((size = recv(socket_fd_, buffer, sizeof(buffer), 0)) > 0) {
+        HandleUevent(QByteArray(buffer, static_cast<int>(size)));
+    }
+#endif
+}
+
+void HotplugWatcher::HandleUevent(const QByteArray& uevent) {
+    QByteArray action;
+    QByteArray subsystem;
+    QByteArray dev_path;
+    QByteArray dev_name;
+
+    const QList<QByteArray> fields = uevent.split('\0');
+    for (const QByteArray& field : fields) {
+        if (field.startsWith("ACTION=")) {
+            action = field.mid(sizeof("ACTION=") - 1);
+        } else if (field.startsWith("SUBSYSTEM=")) {
+            subsystem = field.mid(sizeof("SUBSYSTEM=") - 1);
+        } else if (field.startsWith("DEVPATH=")) {
+            dev_path = field.mid(sizeof("DEVPATH=") - 1);
+        } else if (field.startsWith("DEVNAME=")) {
+            dev_name = field.mid(sizeof("DEVNAME=") - 1);
+        }
+    }
+
+    if ((subsystem != kTtySubsystem) || dev_name.isEmpty() || dev_path.startsWith(kVirtualDevPath)) {
+        return;
+    }
+
+    if (action == "add") {
+        emit PortAdded(QString::fromLocal8Bit(dev_name));
+    } else if (action == "remove") {
+        emit PortRemoved(QString::fromLocal8Bit(dev_name));
+    }
+}
+
+} // namespace communication
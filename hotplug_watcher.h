@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef HOTPLUG_WATCHER_H_
+#define HOTPLUG_WATCHER_H_
+
+#include <memory>
+#include <QObject>
+#include <QSocketNotifier>
+
+namespace communication {
+
+/*!
+ * \brief The HotplugWatcher class, reports serial ports added or removed by the kernel. On Linux it listens to kernel
+ * uevents on a netlink socket, on other systems it is never active and ports have to be polled.
+ */
+class HotplugWatcher : public QObject {
+
+    Q_OBJECT
+
+  public:
+    /*!
+     * \brief HotplugWatcher constructor
+     */
+    HotplugWatcher();
+
+    /*!
+     * \brief HotplugWatcher destructor
+     */
+    ~HotplugWatcher();
+
+    /*!
+     * \brief Start listening to kernel uevents
+     * \return True if hotplug events are available, false otherwise
+     */
+    bool Start();
+
+    /*!
+     * \brief Stop listening to kernel uevents, called on the thread that started the watcher
+     */
+    void Stop();
+
+    /*!
+     * \brief Check if watcher listens to kernel uevents
+     * \return True if watcher is active, false otherwise
+     */
+    bool IsActive() const;
+
+    /*!
+     * \brief Handle uevent as if it was received from the kernel, used for testing without hardware
+     * \param uevent - Uevent message, NUL separated "ACTION@DEVPATH" header and KEY=VALUE pairs
+     */
+    void InjectUevent(const QByteArray& uevent);
+
+  signals:
+    /*!
+     * \brief Port added signal
+     * \param port_name - Port name, e.g. ttyACM0
+     */
+    void PortAdded(const QString& port_name);
+
+    /*!
+     * \brief Port removed signal
+     * \param port_name - Port name, e.g. ttyACM0
+     */
+    void PortRemoved(const QString& port_name);
+
+  private:
+    /*!
+     * \brief Method used to read all pending uevents from the netlink socket
+     */
+    void ReadUevents();
+
+    /*!
+     * \brief Method used to parse uevent and emit signal for tty devices
+     * \param uevent - Uevent message
+     */
+    void HandleUevent(const QByteArray& uevent);
+
+    int socket_fd_{-1};                                 //!< Netlink socket file descriptor
+    std::unique_ptr<QSocketNotifier> socket_notifier_;  //!< Notifier for the netlink socket, child of the watcher
+};
+
+} // namespace communication
+#endif // HOTPLUG_WATCHER_H_
@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "image_stream.h"
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace flasher {
+
+bool ImageStream::SetSize(qint64 size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (is_aborted_ || (size < 0) || (size > std::numeric_limits<int>::max()) || ((size_ >= 0) && (size_ != size))) {
+        return false;
+    }
+
+    if (size_ < 0) {
+        data_.resize(static_cast<int>(size));
+        size_ = size;
+        condition_.notify_all();
+    }
+
+    return true;
+}
+
+void ImageStream::SetChecksum(const QString& checksum) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    checksum_ = checksum;
+}
+
+QString ImageStream::Checksum() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return checksum_;
+}
+
+bool ImageStream::Append(const char *data, int size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (is_aborted_ || (size_ < 0) || ((available_size_ + size) > size_)) {
+        return false;
+    }
+
+    // Data goes to the part of the image that is not read yet
+    std::memcpy(data_.data() + available_size_, data, static_cast<size_t>(size));
+    available_size_ += size;
+    received_size_ += size;
+    condition_.notify_all();
+
+    return true;
+}
+
+void ImageStream::ReportReceived(qint64 size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    received_size_ += size;
+    condition_.notify_all();
+}
+
+void ImageStream::Finish(bool success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_success_ = success && !is_aborted_ && (size_ >= 0) && (available_size_ == size_);
+    is_finished_ = true;
+    condition_.notify_all();
+}
+
+void ImageStream::Abort() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_aborted_ = true;
+    condition_.notify_all();
+}
+
+bool ImageStream::WaitForSize(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return WaitWhileProgressing(lock, timeout_ms, [this]() { return size_ >= 0; });
+}
+
+bool ImageStream::WaitForData(qint64 size, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return WaitWhileProgressing(lock, timeout_ms, [this, size]() { return available_size_ >= size; });
+}
+
+bool ImageStream::WaitForFinish(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return WaitWhileProgressing(lock, timeout_ms, [this]() { return is_finished_; }) && is_success_;
+}
+
+QByteArray ImageStream::Content() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Image is allocated once, so the view stays valid while data is appended behind it
+    return QByteArray::fromRawData(data_.constData(), data_.size());
+}
+
+template <typename Condition>
+bool ImageStream::WaitWhileProgressing(std::unique_lock<std::mutex>& lock, int timeout_ms, Condition is_done) {
+    qint64 last_received_size = received_size_;
+
+    while (!is_done()) {
+        // Finished or aborted download will not bring any more data
+        if (is_finished_ || is_aborted_) {
+            return false;
+        }
+
+        const bool is_changed = condition_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&]() {
+            return is_done() || is_finished_ || is_aborted_ || (received_size_ != last_received_size);
+        });
+
+        if (!is_changed) {
+            return false;
+        }
+
+        last_received_size = received_size_;
+    }
+
+    return true;
+}
+
+} // namespace flasher
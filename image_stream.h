@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef IMAGE_STREAM_H_
+#define IMAGE_STREAM_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <QByteArray>
+#include <QString>
+
+namespace flasher {
+
+/*!
+ * \brief The ImageStream class, image that is flashed while it is still downloading. Download thread announces the size
+ * and appends data, flashing thread waits only for the part it needs next. Image is stored at its final place, so data
+ * that arrived is never moved or copied again.
+ */
+class ImageStream {
+
+  public:
+    /*!
+     * \brief Set image size, called by the download thread once before the first data
+     * \param size - Image size in bytes
+     * \return True if size is set, false if it differs from the size that is already set or download is aborted
+     */
+    bool SetSize(qint64 size);
+
+    /*!
+     * \brief Set checksum of the image announced by its source, called by the download thread before the size
+     * \param checksum - Checksum, e.g. server CRC and size or HTTP ETag
+     */
+    void SetChecksum(const QString& checksum);
+
+    /*!
+     * \brief Get checksum of the image announced by its source
+     * \return Checksum, empty if source did not announce it
+     */
+    QString Checksum() const;
+
+    /*!
+     * \brief Append downloaded data, called by the download thread
+     * \param data - Pointer to data
+     * \param size - Data size
+     * \return True if data is appended, false if download is aborted or data does not fit the image
+     */
+    bool Append(const char *data, int size);
+
+    /*!
+     * \brief Report data that the download thread holds back until the image size is known, it counts as progress of
+     * the download so waiting for the size does not time out while data keeps arriving
+     * \param size - Data size
+     */
+    void ReportReceived(qint64 size);
+
+    /*!
+     * \brief Finish download, called by the download thread
+     * \param success - True if download is verified
+     */
+    void Finish(bool success);
+
+    /*!
+     * \brief Abort download, Append returns false from now on
+     */
+    void Abort();
+
+    /*!
+     * \brief Wait until image size is known
+     * \param timeout_ms - Timeout in [ms]
+     * \return True if size is known, false if download failed or timed out
+     */
+    bool WaitForSize(int timeout_ms);
+
+    /*!
+     * \brief Wait until first size bytes of the image arrive
+     * \param size - Number of bytes from the start of the image
+     * \param timeout_ms - Max time in [ms] without new data, zero only checks the data that is already here
+     * \return True if data is here, false if download failed or no data arrived in time
+     */
+    bool WaitForData(qint64 size, int timeout_ms);
+
+    /*!
+     * \brief Wait until download is finished
+     * \param timeout_ms - Max time in [ms] without new data
+     * \return True if whole image is downloaded and verified, false otherwise
+     */
+    bool WaitForFinish(int timeout_ms);
+
+    /*!
+     * \brief Get image content, bytes that did not arrive yet must not be read
+     * \return View of the image, valid while the stream exists
+     */
+    QByteArray Content() const;
+
+  private:
+    /*!
+     * \brief Method used to wait until condition is met, timeout restarts whenever new data is received
+     * \param lock - Locked stream mutex
+     * \param timeout_ms - Max time in [ms] without new data
+     * \param is_done - Condition
+     * \return True if condition is met, false on timeout
+     */
+    template <typename Condition>
+    bool WaitWhileProgressing(std::unique_lock<std::mutex>& lock, int timeout_ms, Condition is_done);
+
+    mutable std::mutex mutex_;              //!< Guards stream state
+    std::condition_variable condition_;     //!< Notified on every change of the stream state
+    QByteArray data_;                       //!< Image, allocated once its size is known
+    QString checksum_;                      //!< Checksum of the image announced by its source
+    qint64 size_{-1};                       //!< Image size, negative until it is known
+    qint64 available_size_{0};              //!< Number of bytes that arrived
+    qint64 received_size_{0};               //!< Number of bytes received by the download thread, including held back data
+    bool is_finished_{false};               //!< Download is finished
+    bool is_success_{false};                //!< Download is complete and verified
+    bool is_aborted_{false};                //!< Download is aborted
+};
+
+} // namespace flasher
+
+#endif // IMAGE_STREAM_H_
@@ -1,6 +1,8 @@
 QT += widgets serialport network
 requires(qtConfig(combobox))
 
+CONFIG += c++14
+
 TARGET = imflasher
 TEMPLATE = app
 
@@ -13,25 +15,40 @@ DEFINES += GIT_TAG=\\\"$$GIT_TAG\\\"
 DEFINES += GIT_HASH=\\\"$$GIT_HASH\\\"
 DEFINES += GIT_BRANCH=\\\"$$GIT_BRANCH\\\"
 SOURCES += \
+    async_flash_session.cpp \
     crc32.cpp \
+    firmware_cache.cpp \
     file_downloader.cpp \
     flasher.cpp \
+    frame.cpp \
+    gang_flasher.cpp \
+    hotplug_watcher.cpp \
+    image_stream.cpp \
     main.cpp \
     mainwindow.cpp \
+    native_serial_port.cpp \
+    ring_buffer.cpp \
     serial_port.cpp \
-    socket_client.cpp \
-    worker.cpp
+    socket_client.cpp
 
 HEADERS += \
+    async_flash_session.h \
     crc32.h \
     file_downloader.h \
+    firmware_cache.h \
     flasher.h \
+    flasher_protocol.h \
     flasher_states.h \
     flashing_info.h \
+    frame.h \
+    gang_flasher.h \
+    hotplug_watcher.h \
+    image_stream.h \
     mainwindow.h \
+    native_serial_port.h \
+    ring_buffer.h \
     serial_port.h \
-    socket_client.h \
-    worker.h
+    socket_client.h
 
 FORMS += \
     mainwindow.ui
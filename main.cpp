@@ -34,9 +34,11 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include "flasher.h"
 #include "flashing_info.h"
+#include "gang_flasher.h"
 #include "mainwindow.h"
 #include "serial_port.h"
 
@@ -49,6 +51,23 @@ int main(int argc, char *argv[]) {
         QString action = argv[1];
         QString file_path = argv[2];
 
+        // Flash all detected boards in parallel, one thread per board or all boards from one thread
+        const bool is_flash_all_async = (0 == QString::compare("flash_all_async", action, Qt::CaseInsensitive));
+        if (is_flash_all_async || (0 == QString::compare("flash_all", action, Qt::CaseInsensitive))) {
+            if (!(flasher->OpenFile(file_path) && flasher->SetLocalFileContent())) {
+                qInfo() << "Open file error";
+                return 1;
+            }
+
+            QCoreApplication app(argc, argv);
+            QElapsedTimer timer;
+            timer.start();
+            const flasher::GangFlasher gang_flasher(flasher->GetFileContent());
+            const QVector<flasher::GangResult> results = is_flash_all_async ? gang_flasher.FlashAllAsync() : gang_flasher.FlashAll();
+
+            return flasher::GangFlasher::PrintSummary(results, timer.elapsed()) ? 0 : 1;
+        }
+
         flasher->TryToConnectConsole();
 
         if (!(flasher->IsBootloaderDetected())) {
@@ -76,7 +95,7 @@ int main(int argc, char *argv[]) {
                         qInfo() << "Open file error";
                     }
                 } else {
-                    qInfo() << "Select flash or erase";
+                    qInfo() << "Select flash, flash_all, flash_all_async or erase";
                 }
             }
         }
@@ -84,10 +103,15 @@ int main(int argc, char *argv[]) {
         // Run GUI solution
         QApplication app(argc, argv);
         app.setWindowIcon(QIcon(":/images/capman.png"));
-        gui::MainWindow window(flasher);
-        flasher->Init();
-        window.show();
-        app.exec();
+        {
+            gui::MainWindow window(flasher);
+            flasher->Init();
+            window.show();
+            app.exec();
+        }
+
+        // Engine thread is stopped while application still processes the dialogs it may wait for
+        flasher.reset();
     }
 
     return 0;
@@ -51,9 +51,10 @@ MainWindow::MainWindow(std::shared_ptr<flasher::Flasher> flasher) :
     DisableAllButtons();
     ClearProgress();
 
+    // Flasher runs on its own thread, all its signals are queued to the GUI thread
     connect(flasher_.get(), &flasher::Flasher::UpdateProgressBarSignal, this, [&] (const quint8& progress_percentage) { // *NOPAD*
         ui_.progressBar->setValue(progress_percentage);
-    }, Qt::DirectConnection);
+    }, Qt::QueuedConnection);
 
     connect(flasher_.get(), &flasher::Flasher::ClearProgress, this, &MainWindow::ClearProgress);
 
@@ -75,6 +76,7 @@ MainWindow::MainWindow(std::shared_ptr<flasher::Flasher> flasher) :
     connect(flasher_.get(), &flasher::Flasher::ClearTextInBrowser, this, [&] {  ui_.textBrowser->clear(); });
 
     connect(flasher_.get(), &flasher::Flasher::SetButtons, this, [&] (const auto& is_bootloader) { // *NOPAD*
+        is_bootloader_ = is_bootloader;
         ui_.enterBootloader->setEnabled(true);
 
         if (is_bootloader) {
@@ -89,6 +91,7 @@ MainWindow::MainWindow(std::shared_ptr<flasher::Flasher> flasher) :
     });
 
     connect(flasher_.get(), &flasher::Flasher::SetReadProtectionButtonText, this, [&] (const auto& is_enabled) { // *NOPAD*
+        is_read_protection_enabled_ = is_enabled;
         if (is_enabled) {
             ui_.protectButton->setText("Disable read protection");
         } else {
@@ -186,7 +189,7 @@ void MainWindow::on_loadFile_clicked() {
 }
 
 void MainWindow::on_enterBootloader_clicked() {
-    if (flasher_->IsBootloaderDetected()) {
+    if (is_bootloader_) {
         flasher_->SetState(flasher::FlasherStates::kExitBootloader);
     } else {
         flasher_->SetState(flasher::FlasherStates::kEnterBootloader);
@@ -194,7 +197,7 @@ void MainWindow::on_enterBootloader_clicked() {
 }
 
 void MainWindow::on_protectButton_clicked() {
-    if (flasher_->IsReadProtectionEnabled()) {
+    if (is_read_protection_enabled_) {
         flasher_->SetState(flasher::FlasherStates::kDisableReadProtection);
     } else {
         flasher_->SetState(flasher::FlasherStates::kEnableReadProtection);
@@ -89,6 +89,8 @@ class MainWindow : public QMainWindow {
   private:
     Ui::MainWindow ui_;                                         //!< Ui::MainWindow
     std::shared_ptr<flasher::Flasher> flasher_;                 //!< Shared pointer to the flasher object
+    bool is_bootloader_ {false};                                //!< Is bootloader detected, as reported by the flasher
+    bool is_read_protection_enabled_ {false};                   //!< Is read protection enabled, as reported by the flasher
 
     //! Version information constant, contains git tag, git branch and git hash
     const std::string version_info_ =
@@ -0,0 +1,308 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "native_serial_port.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace communication {
+namespace {
+
+constexpr int kRxBufferSize {16384};
+constexpr int kMinRxFreeSpace {4096};   //!< Rx buffer grows when less free space is left, so one read never gets truncated
+constexpr int kWriteTimeoutInMs {1000}; //!< Max time in [ms] that driver output buffer may stay full
+constexpr char kLatencyTimerPath[] = "/sys/class/tty/%1/device/latency_timer";
+constexpr char kMinLatencyTimer[] = "1";   //!< USB-serial bridges with latency timer (FTDI) hold Rx data for this long in [ms]
+
+#ifdef Q_OS_LINUX
+bool ToSpeed(qint32 baud_rate, speed_t& speed) {
+    switch (baud_rate) {
+        case 9600: speed = B9600; break;
+        case 19200: speed = B19200; break;
+        case 38400: speed = B38400; break;
+        case 57600: speed = B57600; break;
+        case 115200: speed = B115200; break;
+        case 230400: speed = B230400; break;
+        case 460800: speed = B460800; break;
+        case 500000: speed = B500000; break;
+        case 921600: speed = B921600; break;
+        case 1000000: speed = B1000000; break;
+        case 1500000: speed = B1500000; break;
+        case 2000000: speed = B2000000; break;
+        case 3000000: speed = B3000000; break;
+        default: return false;
+    }
+
+    return true;
+}
+
+bool SetTermios(int fd, qint32 baud_rate, bool is_hardware_flow_control_enabled, int optional_actions) {
+    speed_t speed;
+    termios settings {};
+    if (!ToSpeed(baud_rate, speed) || (tcgetattr(fd, &settings) < 0)) {
+        return false;
+    }
+
+    // Raw 8N1, reads never block in the driver, waiting is done with epoll
+    cfmakeraw(&settings);
+    settings.c_cflag |= CLOCAL | CREAD;
+    settings.c_cflag &= ~CSTOPB;
+    if (is_hardware_flow_control_enabled) {
+        settings.c_cflag |= CRTSCTS;
+    } else {
+        settings.c_cflag &= ~CRTSCTS;
+    }
+    settings.c_cc[VMIN] = 0;
+    settings.c_cc[VTIME] = 0;
+    cfsetispeed(&settings, speed);
+    cfsetospeed(&settings, speed);
+
+    return tcsetattr(fd, optional_actions, &settings) == 0;
+}
+
+// Best effort, drivers without the feature and pseudo terminals keep their defaults
+void SetLowLatency(int fd, const QString& device_path) {
+    serial_struct serial_info {};
+    if (ioctl(fd, TIOCGSERIAL, &serial_info) == 0) {
+        serial_info.flags |= ASYNC_LOW_LATENCY;
+        ioctl(fd, TIOCSSERIAL, &serial_info);
+    }
+
+    QFile latency_timer(QString(kLatencyTimerPath).arg(QFileInfo(device_path).fileName()));
+    if (latency_timer.open(QIODevice::WriteOnly)) {
+        latency_timer.write(kMinLatencyTimer);
+    }
+}
+#endif
+
+} // namespace
+
+NativeSerialPort::NativeSerialPort() :
+    rx_buffer_(kRxBufferSize) {
+}
+
+NativeSerialPort::~NativeSerialPort() {
+    Close();
+}
+
+bool NativeSerialPort::Open(const QString& device_path, qint32 baud_rate, bool is_hardware_flow_control_enabled) {
+#ifdef Q_OS_LINUX
+    Close();
+    has_error_ = false;
+    rx_buffer_.Clear();
+
+    fd_ = open(QFile::encodeName(device_path).constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = fd_;
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+
+    if ((ioctl(fd_, TIOCEXCL) < 0) || !SetTermios(fd_, baud_rate, is_hardware_flow_control_enabled, TCSANOW) ||
+        (epoll_fd_ < 0) || (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &event) < 0)) {
+        Close();
+        return false;
+    }
+
+    SetLowLatency(fd_, device_path);
+    tcflush(fd_, TCIOFLUSH);
+
+    return true;
+#else
+    Q_UNUSED(device_path)
+    Q_UNUSED(baud_rate)
+    Q_UNUSED(is_hardware_flow_control_enabled)
+    qInfo() << "Native serial port not available";
+    return false;
+#endif
+}
+
+void NativeSerialPort::Close() {
+#ifdef Q_OS_LINUX
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+
+    if (fd_ >= 0) {
+        ioctl(fd_, TIOCNXCL);
+        close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+bool NativeSerialPort::IsOpen() const {
+    return fd_ >= 0;
+}
+
+bool NativeSerialPort::HasError() const {
+    return has_error_;
+}
+
+bool NativeSerialPort::SetLinkSettings(qint32 baud_rate, bool is_hardware_flow_control_enabled) {
+#ifdef Q_OS_LINUX
+    return IsOpen() && SetTermios(fd_, baud_rate, is_hardware_flow_control_enabled, TCSADRAIN);
+#else
+    Q_UNUSED(baud_rate)
+    Q_UNUSED(is_hardware_flow_control_enabled)
+    return false;
+#endif
+}
+
+qint64 NativeSerialPort::Write(const char *data, qint64 size) {
+#ifdef Q_OS_LINUX
+    qint64 written = 0;
+
+    while (IsOpen() && (written < size)) {
+        const ssize_t result = write(fd_, data + written, static_cast<size_t>(size - written));
+        if (result >= 0) {
+            written += result;
+        } else if (errno == EAGAIN) {
+            // Driver output buffer is full, e.g. peer holds CTS
+            pollfd poll_fd {fd_, POLLOUT, 0};
+            if (poll(&poll_fd, 1, kWriteTimeoutInMs) <= 0) {
+                break;
+            }
+        } else if (errno != EINTR) {
+            CloseOnError();
+            return -1;
+        }
+    }
+
+    return written;
+#else
+    Q_UNUSED(data)
+    Q_UNUSED(size)
+    return -1;
+#endif
+}
+
+bool NativeSerialPort::WaitForReadyRead(int timeout) {
+#ifdef Q_OS_LINUX
+    if (!IsOpen()) {
+        return false;
+    }
+
+    epoll_event event {};
+    int result;
+    do {
+        result = epoll_wait(epoll_fd_, &event, 1, timeout);
+    } while ((result < 0) && (errno == EINTR));
+
+    if (result <= 0) {
+        return false;
+    }
+
+    if (ReadAvailable()) {
+        return true;
+    }
+
+    // Hang up without data, device is gone
+    if (event.events & (EPOLLHUP | EPOLLERR)) {
+        CloseOnError();
+    }
+
+    return false;
+#else
+    Q_UNUSED(timeout)
+    return false;
+#endif
+}
+
+RingBuffer& NativeSerialPort::RxBuffer() {
+    return rx_buffer_;
+}
+
+const RingBuffer& NativeSerialPort::RxBuffer() const {
+    return rx_buffer_;
+}
+
+bool NativeSerialPort::ReadAvailable() {
+#ifdef Q_OS_LINUX
+    bool is_read = false;
+
+    while (IsOpen()) {
+        rx_buffer_.ReserveFreeSpace(kMinRxFreeSpace);
+
+        // Free space may wrap at the end of the buffer, one vectored read fills both parts
+        RingBuffer::Span first;
+        RingBuffer::Span second;
+        rx_buffer_.GetFreeSpans(first, second);
+        iovec spans[2] {{first.data, static_cast<size_t>(first.size)}, {second.data, static_cast<size_t>(second.size)}};
+
+        const ssize_t result = readv(fd_, spans, (second.size > 0) ? 2 : 1);
+        if (result > 0) {
+            rx_buffer_.Commit(static_cast<int>(result));
+            is_read = true;
+            if (result < first.size + second.size) {
+                break;
+            }
+        } else if ((result == 0) || (errno == EAGAIN)) {
+            break;
+        } else if (errno != EINTR) {
+            CloseOnError();
+        }
+    }
+
+    return is_read;
+#else
+    return false;
+#endif
+}
+
+void NativeSerialPort::CloseOnError() {
+    qInfo() << "Native serial port I/O error";
+    Close();
+    has_error_ = true;
+}
+
+} // namespace communication
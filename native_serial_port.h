@@ -0,0 +1,145 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef NATIVE_SERIAL_PORT_H_
+#define NATIVE_SERIAL_PORT_H_
+
+#include <QString>
+
+#include "ring_buffer.h"
+
+namespace communication {
+
+/*!
+ * \brief The NativeSerialPort class, serial port that talks to termios directly. Port is set to the driver's low
+ * latency mode, readiness is waited with epoll and data is read straight into a ring buffer. Available on Linux only,
+ * on other systems the port never opens.
+ */
+class NativeSerialPort {
+
+  public:
+    /*!
+     * \brief NativeSerialPort constructor
+     */
+    NativeSerialPort();
+
+    /*!
+     * \brief NativeSerialPort destructor
+     */
+    ~NativeSerialPort();
+
+    NativeSerialPort(const NativeSerialPort&) = delete;
+    NativeSerialPort& operator=(const NativeSerialPort&) = delete;
+
+    /*!
+     * \brief Open port as 8N1 raw terminal
+     * \param device_path - Path of the terminal device, e.g. /dev/ttyACM0
+     * \param baud_rate - Baud rate
+     * \param is_hardware_flow_control_enabled - Use RTS/CTS flow control
+     * \return True if port is successfully opened, false otherwise
+     */
+    bool Open(const QString& device_path, qint32 baud_rate, bool is_hardware_flow_control_enabled);
+
+    /*!
+     * \brief Close port, data that is already buffered stays readable until the port is opened again
+     */
+    void Close();
+
+    /*!
+     * \brief Check if port is open
+     * \return True if port is open, false otherwise
+     */
+    bool IsOpen() const;
+
+    /*!
+     * \brief Check if port was closed because of an I/O error, e.g. device was unplugged
+     * \return True if last read or write failed, false otherwise
+     */
+    bool HasError() const;
+
+    /*!
+     * \brief Change link settings of the open port, pending output is sent first
+     * \param baud_rate - Baud rate
+     * \param is_hardware_flow_control_enabled - Use RTS/CTS flow control
+     * \return True if settings are applied, false otherwise
+     */
+    bool SetLinkSettings(qint32 baud_rate, bool is_hardware_flow_control_enabled);
+
+    /*!
+     * \brief Write data, blocks until all data is handed to the driver
+     * \param data - Data
+     * \param size - Data size in [B]
+     * \return Number of written bytes, -1 on error
+     */
+    qint64 Write(const char *data, qint64 size);
+
+    /*!
+     * \brief Wait until data is received and read all available data into the Rx buffer
+     * \param timeout - Timeout in [ms], 0 only reads data that is already available
+     * \return True if new data is buffered, false on timeout or error
+     */
+    bool WaitForReadyRead(int timeout);
+
+    /*!
+     * \brief Get buffer with received data, consumers read and remove data in place
+     * \return Reference to the Rx buffer
+     */
+    RingBuffer& RxBuffer();
+
+    /*!
+     * \brief Get buffer with received data
+     * \return Reference to the Rx buffer
+     */
+    const RingBuffer& RxBuffer() const;
+
+  private:
+    /*!
+     * \brief Method used to read all available data into the Rx buffer
+     * \return True if new data is buffered, false otherwise
+     */
+    bool ReadAvailable();
+
+    /*!
+     * \brief Method used to close port after an I/O error
+     */
+    void CloseOnError();
+
+    int fd_{-1};                    //!< Terminal file descriptor
+    int epoll_fd_{-1};              //!< Epoll instance that waits for Rx data
+    bool has_error_{false};         //!< Port was closed because of an I/O error
+    RingBuffer rx_buffer_;          //!< Received data that is not read yet
+};
+
+} // namespace communication
+#endif // NATIVE_SERIAL_PORT_H_
@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace communication {
+
+bool ByteView::IsEmpty() const {
+    return size == 0;
+}
+
+bool ByteView::EqualsIgnoreCase(const char *text) const {
+    return (qstrlen(text) == static_cast<uint>(size)) && (qstrnicmp(data, text, static_cast<uint>(size)) == 0);
+}
+
+RingBuffer::RingBuffer(int capacity) :
+    storage_(static_cast<size_t>(qMax(capacity, 0))) {
+}
+
+void RingBuffer::Reserve(int capacity) {
+    if (capacity <= Capacity()) {
+        return;
+    }
+
+    std::vector<char> storage(static_cast<size_t>(capacity));
+    if (size_ > 0) {
+        std::memcpy(storage.data(), Linearize(), static_cast<size_t>(size_));
+    }
+
+    storage_.swap(storage);
+    head_ = 0;
+}
+
+int RingBuffer::Capacity() const {
+    return static_cast<int>(storage_.size());
+}
+
+int RingBuffer::Size() const {
+    return size_;
+}
+
+bool RingBuffer::IsEmpty() const {
+    return size_ == 0;
+}
+
+void RingBuffer::ReserveFreeSpace(int size) {
+    if (size_ + size > Capacity()) {
+        Reserve(qMax(size_ + size, 2 * Capacity()));
+    }
+}
+
+void RingBuffer::Append(const char *data, int size) {
+    if (size <= 0) {
+        return;
+    }
+
+    ReserveFreeSpace(size);
+
+    Span first;
+    Span second;
+    GetFreeSpans(first, second);
+
+    const int first_size = qMin(size, first.size);
+    std::memcpy(first.data, data, static_cast<size_t>(first_size));
+    std::memcpy(second.data, data + first_size, static_cast<size_t>(size - first_size));
+    Commit(size);
+}
+
+void RingBuffer::GetFreeSpans(Span& first, Span& second) {
+    first = Span();
+    second = Span();
+
+    const int capacity = Capacity();
+    if (size_ == capacity) {
+        return;
+    }
+
+    const int tail = (head_ + size_) % capacity;
+    first.data = storage_.data() + tail;
+
+    if (tail >= head_) {
+        first.size = capacity - tail;
+        second.data = storage_.data();
+        second.size = head_;
+    } else {
+        first.size = head_ - tail;
+    }
+}
+
+void RingBuffer::Commit(int size) {
+    size_ = qMin(size_ + size, Capacity());
+}
+
+const char *RingBuffer::Linearize() {
+    if (head_ + size_ > Capacity()) {
+        std::rotate(storage_.begin(), storage_.begin() + head_, storage_.end());
+        head_ = 0;
+    }
+
+    return storage_.data() + head_;
+}
+
+ByteView RingBuffer::View() {
+    ByteView view;
+    view.data = Linearize();
+    view.size = size_;
+    return view;
+}
+
+char RingBuffer::At(int index) const {
+    return storage_[static_cast<size_t>((head_ + index) % Capacity())];
+}
+
+void RingBuffer::Consume(int size) {
+    size = qMin(size, size_);
+    size_ -= size;
+
+    // Empty buffer starts at the beginning of the storage, so the next write is not split
+    head_ = (size_ == 0) ? 0 : ((head_ + size) % Capacity());
+}
+
+QByteArray RingBuffer::Take(int size) {
+    size = qMin(size, size_);
+    const QByteArray data(Linearize(), size);
+    Consume(size);
+    return data;
+}
+
+void RingBuffer::Clear() {
+    head_ = 0;
+    size_ = 0;
+}
+
+} // namespace communication
@@ -0,0 +1,181 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2026 IMProject Development Team. All rights reserved.
+ *   Authors: Igor Misic <igy1000mb@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name IMProject nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+#include <vector>
+#include <QByteArray>
+
+namespace communication {
+
+/*!
+ * \brief The ByteView struct, read-only view of bytes owned by a buffer, valid until the buffer is modified
+ */
+struct ByteView {
+    const char *data {nullptr};     //!< First byte
+    int size {0};                   //!< Number of bytes
+
+    /*!
+     * \brief Check if view is empty
+     * \return True if there are no bytes in the view, false otherwise
+     */
+    bool IsEmpty() const;
+
+    /*!
+     * \brief Compare view with a string, ignoring case. Nothing is allocated, so it is used on the per-packet path.
+     * \param text - NUL terminated string
+     * \return True if view holds exactly the given string, false otherwise
+     */
+    bool EqualsIgnoreCase(const char *text) const;
+};
+
+/*!
+ * \brief The RingBuffer class, byte FIFO with preallocated storage. Producers write directly into the free space and
+ * consumers read buffered data in place, so data is not copied or allocated per chunk.
+ */
+class RingBuffer {
+
+  public:
+    /*!
+     * \brief The Span struct, contiguous part of the buffer storage
+     */
+    struct Span {
+        char *data {nullptr};   //!< Start of the span
+        int size {0};           //!< Number of bytes in the span
+    };
+
+    /*!
+     * \brief RingBuffer constructor
+     * \param capacity - Initial capacity in [B]
+     */
+    explicit RingBuffer(int capacity = 0);
+
+    /*!
+     * \brief Grow storage to at least the given capacity, buffered data is kept
+     * \param capacity - Capacity in [B]
+     */
+    void Reserve(int capacity);
+
+    /*!
+     * \brief Get capacity of the storage
+     * \return Capacity in [B]
+     */
+    int Capacity() const;
+
+    /*!
+     * \brief Get number of buffered bytes
+     * \return Number of buffered bytes
+     */
+    int Size() const;
+
+    /*!
+     * \brief Check if buffer is empty
+     * \return True if there is no buffered data, false otherwise
+     */
+    bool IsEmpty() const;
+
+    /*!
+     * \brief Make sure that at least the given number of bytes fits into the free space, storage at least doubles when
+     * it grows so repeated small writes do not reallocate each time
+     * \param size - Number of bytes in [B]
+     */
+    void ReserveFreeSpace(int size);
+
+    /*!
+     * \brief Copy data to the end of the buffer, storage grows if data does not fit
+     * \param data - Data
+     * \param size - Data size in [B]
+     */
+    void Append(const char *data, int size);
+
+    /*!
+     * \brief Get free space of the buffer. Free space wraps at the end of the storage, so it is returned as two spans
+     * which can be filled with one vectored read. Filled bytes are added to the buffer with Commit().
+     * \param first - Free space after the buffered data
+     * \param second - Free space at the start of the storage, empty if free space does not wrap
+     */
+    void GetFreeSpans(Span& first, Span& second);
+
+    /*!
+     * \brief Add bytes written into the free spans to the buffer
+     * \param size - Number of written bytes
+     */
+    void Commit(int size);
+
+    /*!
+     * \brief Get buffered data as one contiguous block. Data is moved only if it wraps at the end of the storage.
+     * \return Pointer to Size() buffered bytes, valid until the buffer is modified
+     */
+    const char *Linearize();
+
+    /*!
+     * \brief Get view of the buffered data, data is moved only if it wraps at the end of the storage
+     * \return View of Size() buffered bytes
+     */
+    ByteView View();
+
+    /*!
+     * \brief Get buffered byte
+     * \param index - Index from the start of buffered data, must be lower than Size()
+     * \return Buffered byte
+     */
+    char At(int index) const;
+
+    /*!
+     * \brief Remove bytes from the start of the buffer
+     * \param size - Number of bytes to remove
+     */
+    void Consume(int size);
+
+    /*!
+     * \brief Copy bytes from the start of the buffer and remove them
+     * \param size - Number of bytes to take
+     * \return Taken bytes, fewer than size if there is not enough buffered data
+     */
+    QByteArray Take(int size);
+
+    /*!
+     * \brief Remove all buffered data, capacity is kept
+     */
+    void Clear();
+
+  private:
+    std::vector<char> storage_;     //!< Buffer storage
+    int head_{0};                   //!< Index of the first buffered byte
+    int size_{0};                   //!< Number of buffered bytes
+};
+
+} // namespace communication
+#endif // RING_BUFFER_H_
@@ -34,109 +34,502 @@
 
 #include "serial_port.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QSerialPortInfo>
-#include <QThread>
 
 namespace communication {
 namespace {
 
-constexpr int kMaxNoDataPeriod {10}; //!< Max time in [ms] while waiting for new serial data. 10 ms = 1 kHz for sender minimal task frequency.
+constexpr int kMaxNoDataPeriod {10}; //!< Max time in [ms] with no new serial data before response of unknown length is complete. 10 ms = 1 kHz for sender minimal task frequency.
 constexpr int kSerialTimeoutInMs {100};
+constexpr int kBaudRateFallbackTimeoutInMs {500};   //!< Time in [ms] that bootloader needs to return to default baud rate after failed probe
 constexpr char kSoftwareTypeCmd[] = "software_type";
 constexpr char kSwTypeImBoot[] = "IMBootloader";
 constexpr char kSwTypeImApp[] = "IMApplication";
+constexpr char kSetBaudRateCmd[] = "set_baud_rate ";
+constexpr char kRtsCtsOption[] = " rtscts";
+constexpr int kProbePollPeriodInMs {5};     //!< Period in [ms] in which probe checks if other probe already detected the board
+constexpr char kDevicePathPrefix[] = "/dev/";
+constexpr int kRxBufferSize {16384};
+
+PortIdentity ToPortIdentity(const QSerialPortInfo& info) {
+    PortIdentity port_identity;
+    port_identity.serial_number = info.serialNumber();
+    port_identity.system_location = info.systemLocation();
+    port_identity.vendor_id = info.vendorIdentifier();
+    port_identity.product_id = info.productIdentifier();
+    return port_identity;
+}
+
+// USB serial number survives re-enumeration, location is used only for devices without it
+bool IsSamePort(const PortIdentity& port_identity, const QSerialPortInfo& info) {
+    if (!port_identity.serial_number.isEmpty()) {
+        return port_identity.serial_number == info.serialNumber();
+    }
+
+    return !port_identity.system_location.isEmpty() && (port_identity.system_location == info.systemLocation()) &&
+           (port_identity.vendor_id == info.vendorIdentifier()) && (port_identity.product_id == info.productIdentifier());
+}
+
+// Probe runs in its own thread, it uses blocking calls on a temporary port and gives up once other probe wins
+bool ProbeSoftwareType(const QString& port_name, const std::atomic<bool>& is_detected, bool& is_bootloader) {
+    QSerialPort port;
+    if (!OpenDefaultPort(port, port_name)) {
+        return false;
+    }
+
+    port.write(kSoftwareTypeCmd, sizeof(kSoftwareTypeCmd));
+
+    QByteArray rx_data;
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!is_detected && !timer.hasExpired(kSerialTimeoutInMs)) {
+        if (port.waitForReadyRead(kProbePollPeriodInMs)) {
+            rx_data.append(port.readAll());
+        }
+
+        // Same comparison as DetectBoard, so probe finds every board that OpenPort accepts
+        const ByteView software_type {rx_data.constData(), rx_data.size()};
+        if (software_type.EqualsIgnoreCase(kSwTypeImBoot) || software_type.EqualsIgnoreCase(kSwTypeImApp)) {
+            is_bootloader = software_type.EqualsIgnoreCase(kSwTypeImBoot);
+            return true;
+        }
+    }
+
+    return false;
+}
 
 } // namespace
 
-SerialPort::SerialPort() {
+bool OpenDefaultPort(QSerialPort& port, const QString& port_name) {
+    port.setPortName(port_name);
+    port.setBaudRate(kDefaultBaudRate);
+    port.setDataBits(QSerialPort::Data8);
+    port.setParity(QSerialPort::NoParity);
+    port.setStopBits(QSerialPort::OneStop);
+    port.setFlowControl(QSerialPort::NoFlowControl);
+
+    return port.open(QIODevice::ReadWrite);
+}
+
+SerialPort::SerialPort() :
+    rx_buffer_(kRxBufferSize) {
     connect(this, &communication::SerialPort::readyRead, this, &communication::SerialPort::ReadyRead);
 }
 
 SerialPort::~SerialPort() = default;
 
 void SerialPort::ReadyRead() {
-    serial_rx_data_.append(readAll());
+    // Data is read straight into the free space of the Rx buffer
+    rx_buffer_.ReserveFreeSpace(static_cast<int>(bytesAvailable()));
+
+    RingBuffer::Span first;
+    RingBuffer::Span second;
+    rx_buffer_.GetFreeSpans(first, second);
+
+    qint64 size = read(first.data, first.size);
+    if ((size == first.size) && (second.size > 0)) {
+        size += qMax<qint64>(read(second.data, second.size), 0);
+    }
+
+    rx_buffer_.Commit(static_cast<int>(qMax<qint64>(size, 0)));
 }
 
 void SerialPort::ReadData(QByteArray& data_out) {
-    data_out = serial_rx_data_;
-    serial_rx_data_.clear();
-    previous_rx_data_size_ = 0;
+    ReadData(data_out, RxDataSize());
 }
 
-void SerialPort::WaitForReadyRead(int timeout) {
+void SerialPort::ReadData(QByteArray& data_out, int size) {
+    data_out = RxBuffer().Take(size);
+}
+
+void SerialPort::DiscardData(int size) {
+    RxBuffer().Consume(size);
+}
+
+void SerialPort::ClearRxData() {
+    if (backend_ == SerialBackend::kNative) {
+        native_port_.WaitForReadyRead(0);
+    } else {
+        readAll();
+    }
+    RxBuffer().Clear();
+}
+
+int SerialPort::RxDataSize() const {
+    return RxBuffer().Size();
+}
+
+void SerialPort::SetLinkSettings(qint32 baud_rate, bool is_hardware_flow_control_enabled) {
+    baud_rate_ = baud_rate;
+    is_hardware_flow_control_enabled_ = is_hardware_flow_control_enabled;
+}
+
+ByteView SerialPort::PeekData() {
+    return RxBuffer().View();
+}
+
+qint64 SerialPort::LastRoundTripUs() const {
+    return last_round_trip_us_;
+}
+
+int SerialPort::TransferTimeInMs(qint64 size) const {
+    const qint64 bits = size * 10;
+    return static_cast<int>((bits * 1000 + link_baud_rate_ - 1) / link_baud_rate_);
+}
+
+bool SerialPort::WaitForBytes(int size, int timeout) {
     QElapsedTimer timer;
     timer.start();
 
-    while (!timer.hasExpired(timeout)) {
+    while (RxDataSize() < size) {
+        const qint64 remaining = timeout - timer.elapsed();
+        if ((remaining <= 0) || !IsOpen()) {
+            break;
+        }
 
-        QObject().thread()->msleep(kMaxNoDataPeriod); // Give some time to the sender to send the data
-        waitForReadyRead(1); //QSerial known workaround for triggering readyRead signal(https://bugreports.qt.io/browse/QTBUG-78086)
+        WaitForRxData(static_cast<int>(remaining));
+    }
 
-        int current_rx_data_size = serial_rx_data_.size();
-        if ((current_rx_data_size == previous_rx_data_size_) && (current_rx_data_size != 0)) {
-            // No new data. Ready to read, exit the loop.
+    return (RxDataSize() >= size);
+}
+
+void SerialPort::WaitForReadyRead(int timeout, const CompletionCheck& is_complete) {
+    QElapsedTimer timer;
+    timer.start();
+
+    while (RxBuffer().IsEmpty() || !is_complete || !is_complete(RxBuffer().View())) {
+        const qint64 remaining = timeout - timer.elapsed();
+        if ((remaining <= 0) || !IsOpen()) {
             break;
         }
 
-        previous_rx_data_size_ = current_rx_data_size;
+        // Wait for the first byte up to the timeout, afterwards only as long as the sender may pause within a response
+        const bool is_receiving = !RxBuffer().IsEmpty();
+        const int wait_time = static_cast<int>(is_receiving ? qMin<qint64>(remaining, kMaxNoDataPeriod) : remaining);
+
+        if (!WaitForRxData(wait_time) && is_receiving) {
+            // No new data. Ready to read, exit the loop.
+            break;
+        }
     }
+
+    last_round_trip_us_ = timer.nsecsElapsed() / 1000;
 }
 
 void SerialPort::CloseConn() {
+    if (native_port_.IsOpen()) {
+        native_port_.Close();
+    }
+
     if (isOpen()) {
         close();
     }
 }
 
+void SerialPort::SetBackend(SerialBackend backend) {
+    if (backend != backend_) {
+        CloseConn();
+        backend_ = backend;
+    }
+}
+
+bool SerialPort::IsOpen() const {
+    return (backend_ == SerialBackend::kNative) ? native_port_.IsOpen() : isOpen();
+}
+
+qint64 SerialPort::Write(const char *data, qint64 size) {
+    if (backend_ == SerialBackend::kNative) {
+        const bool was_open = native_port_.IsOpen();
+        const qint64 written = native_port_.Write(data, size);
+        if (was_open && native_port_.HasError()) {
+            emit errorOccurred(QSerialPort::ResourceError);
+        }
+        return written;
+    }
+
+    return write(data, size);
+}
+
+qint64 SerialPort::Write(const QByteArray& data) {
+    return Write(data.constData(), data.size());
+}
+
+RingBuffer& SerialPort::RxBuffer() {
+    return (backend_ == SerialBackend::kNative) ? native_port_.RxBuffer() : rx_buffer_;
+}
+
+const RingBuffer& SerialPort::RxBuffer() const {
+    return (backend_ == SerialBackend::kNative) ? native_port_.RxBuffer() : rx_buffer_;
+}
+
+void SerialPort::ApplyLinkSettings(qint32 baud_rate, bool is_hardware_flow_control_enabled) {
+    link_baud_rate_ = baud_rate;
+
+    if (backend_ == SerialBackend::kNative) {
+        native_port_.SetLinkSettings(baud_rate, is_hardware_flow_control_enabled);
+    } else {
+        setBaudRate(baud_rate);
+        setFlowControl(is_hardware_flow_control_enabled ? QSerialPort::HardwareControl : QSerialPort::NoFlowControl);
+    }
+}
+
+bool SerialPort::WaitForRxData(int timeout) {
+    if (backend_ == SerialBackend::kNative) {
+        const bool was_open = native_port_.IsOpen();
+        const bool is_read = native_port_.WaitForReadyRead(timeout);
+
+        // Error is reported once, when I/O error closes the port
+        if (was_open && native_port_.HasError()) {
+            emit errorOccurred(QSerialPort::ResourceError);
+        }
+        return is_read;
+    }
+
+    // Blocks until data arrives and triggers readyRead signal (https://bugreports.qt.io/browse/QTBUG-78086)
+    return waitForReadyRead(timeout);
+}
+
 bool SerialPort::DetectBoard(bool& is_bootloader) {
     bool is_board_detected;
-    write(kSoftwareTypeCmd, sizeof(kSoftwareTypeCmd));
-    WaitForReadyRead(kSerialTimeoutInMs);
-    QByteArray data_out;
-    ReadData(data_out);
-
-    QString software_type = data_out;
-    if (software_type == kSwTypeImApp) {
+    ClearRxData();
+    Write(kSoftwareTypeCmd, sizeof(kSoftwareTypeCmd));
+    WaitForReadyRead(kSerialTimeoutInMs, [](const ByteView& rx_data) {
+        return rx_data.EqualsIgnoreCase(kSwTypeImApp) || rx_data.EqualsIgnoreCase(kSwTypeImBoot);
+    });
+    const ByteView software_type = PeekData();
+    if (software_type.EqualsIgnoreCase(kSwTypeImApp)) {
         is_bootloader = false;
         is_board_detected = true;
-    } else if (software_type == kSwTypeImBoot) {
+    } else if (software_type.EqualsIgnoreCase(kSwTypeImBoot)) {
         is_bootloader = true;
         is_board_detected = true;
 
     } else {
         is_board_detected = false;
     }
+    DiscardData(software_type.size);
 
     return is_board_detected;
 }
 
+bool SerialPort::NegotiateBaudRate() {
+    if (baud_rate_ <= kDefaultBaudRate) {
+        return true;
+    }
+
+    QByteArray set_baud_rate_cmd = kSetBaudRateCmd + QByteArray::number(baud_rate_);
+    if (is_hardware_flow_control_enabled_) {
+        set_baud_rate_cmd.append(kRtsCtsOption);
+    }
+
+    ClearRxData();
+    Write(set_baud_rate_cmd.constData(), set_baud_rate_cmd.size() + 1);
+    WaitForReadyRead(kSerialTimeoutInMs, [](const ByteView& rx_data) {
+        return rx_data.EqualsIgnoreCase("OK") || rx_data.EqualsIgnoreCase("NOK");
+    });
+    const bool is_accepted = PeekData().EqualsIgnoreCase("OK");
+    DiscardData(RxDataSize());
+
+    if (!is_accepted) {
+        // Older bootloaders do not know the command and stay at the default baud rate
+        qInfo() << "Baud rate: " << kDefaultBaudRate;
+        return true;
+    }
+
+    // Both sides switch, the probe confirms that the link works at the new baud rate
+    ApplyLinkSettings(baud_rate_, is_hardware_flow_control_enabled_);
+
+    bool is_bootloader = false;
+    if (DetectBoard(is_bootloader) && is_bootloader) {
+        qInfo() << "Baud rate: " << baud_rate_ << (is_hardware_flow_control_enabled_ ? "RTS/CTS" : "");
+        return true;
+    }
+
+    // Bootloader returns to the default baud rate on its own when the probe does not arrive
+    qInfo() << "Baud rate probe failed, falling back to" << kDefaultBaudRate;
+    ApplyLinkSettings(kDefaultBaudRate, false);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (!timer.hasExpired(kBaudRateFallbackTimeoutInMs)) {
+        if (DetectBoard(is_bootloader) && is_bootloader) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool SerialPort::OpenConnection(const QString& port_name) {
     if (port_name.isEmpty()) return false;
 
-    setPortName(port_name);
-    setBaudRate(QSerialPort::Baud115200);
-    setDataBits(QSerialPort::Data8);
-    setParity(QSerialPort::NoParity);
+    link_baud_rate_ = kDefaultBaudRate;
+
+    if (backend_ == SerialBackend::kNative) {
+        // Port name keeps port identity available, device is opened by the native port
+        setPortName(port_name);
+        const QString device_path = port_name.startsWith('/') ? port_name : (kDevicePathPrefix + port_name);
+        return native_port_.Open(device_path, kDefaultBaudRate, false);
+    }
+
+    return OpenDefaultPort(*this, port_name);
+}
+
+bool SerialPort::IsPortAccepted(const QSerialPortInfo& info) const {
+    if (!port_filter_.vendor_ids.isEmpty() && (!info.hasVendorIdentifier() || !port_filter_.vendor_ids.contains(info.vendorIdentifier()))) {
+        return false;
+    }
+
+    if (!port_filter_.product_ids.isEmpty() && (!info.hasProductIdentifier() || !port_filter_.product_ids.contains(info.productIdentifier()))) {
+        return false;
+    }
+
+    return port_filter_.manufacturer.isEmpty() || info.manufacturer().contains(port_filter_.manufacturer, Qt::CaseInsensitive);
+}
+
+bool SerialPort::ProbePorts(const QStringList& port_names, QString& detected_port_name, bool& is_bootloader) const {
+    std::atomic<bool> is_detected {false};
+    std::mutex mutex;
+    std::vector<std::thread> probes;
+    probes.reserve(port_names.size());
+
+    for (const QString& port_name : port_names) {
+        probes.emplace_back([&, port_name]() {
+            bool is_probe_bootloader = false;
+            if (ProbeSoftwareType(port_name, is_detected, is_probe_bootloader)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!is_detected) {
+                    detected_port_name = port_name;
+                    is_bootloader = is_probe_bootloader;
+                    is_detected = true;
+                }
+            }
+        });
+    }
+
+    for (auto& probe : probes) {
+        probe.join();
+    }
+
+    return is_detected;
+}
+
+bool SerialPort::IsPreferredPort(const QSerialPortInfo& info) const {
+    if (IsSamePort(last_port_identity_, info)) {
+        return true;
+    }
 
-    setStopBits(QSerialPort::OneStop);
-    setFlowControl(QSerialPort::NoFlowControl);
+    for (const auto& port_identity : preferred_ports_) {
+        if (IsSamePort(port_identity, info)) {
+            return true;
+        }
+    }
 
-    return open(QIODevice::ReadWrite);
+    return false;
+}
+
+bool SerialPort::OpenDetectedPort(const QList<QSerialPortInfo>& infos, bool& is_bootloader) {
+    QStringList port_names;
+    for (const auto& info : infos) {
+        port_names.append(info.portName());
+    }
+
+    QString port_name;
+    if (ProbePorts(port_names, port_name, is_bootloader) && OpenConnection(port_name)) {
+        if (!is_bootloader || NegotiateBaudRate()) {
+            last_port_identity_ = ToPortIdentity(infos.at(port_names.indexOf(port_name)));
+            return true;
+        }
+
+        CloseConn();
+    }
+
+    return false;
 }
 
 bool SerialPort::TryOpenPort(bool& is_bootloader) {
+    QList<QSerialPortInfo> preferred_infos;
+    QList<QSerialPortInfo> other_infos;
     const auto& infos = QSerialPortInfo::availablePorts();
     for (const auto& info : infos) {
-        if (OpenConnection(info.portName())) {
-            if (DetectBoard(is_bootloader)) return true;
-            else CloseConn();
+        if (IsPortAccepted(info)) {
+            if (IsPreferredPort(info)) {
+                preferred_infos.append(info);
+            } else {
+                other_infos.append(info);
+            }
         }
     }
 
+    // Board re-enumerates on the port where it was last seen, probe that port before all the others
+    return (!preferred_infos.isEmpty() && OpenDetectedPort(preferred_infos, is_bootloader)) || OpenDetectedPort(other_infos, is_bootloader);
+}
+
+QStringList SerialPort::FindBoardPorts() const {
+    QStringList port_names;
+    const auto& infos = QSerialPortInfo::availablePorts();
+    for (const auto& info : infos) {
+        if (IsPortAccepted(info)) {
+            port_names.append(info.portName());
+        }
+    }
+
+    // All probes run to the end, no probe wins
+    const std::atomic<bool> is_detected {false};
+    std::mutex mutex;
+    QStringList board_port_names;
+    std::vector<std::thread> probes;
+    probes.reserve(port_names.size());
+
+    for (const QString& port_name : port_names) {
+        probes.emplace_back([&, port_name]() {
+            bool is_bootloader = false;
+            if (ProbeSoftwareType(port_name, is_detected, is_bootloader)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                board_port_names.append(port_name);
+            }
+        });
+    }
+
+    for (auto& probe : probes) {
+        probe.join();
+    }
+
+    board_port_names.sort();
+
+    return board_port_names;
+}
+
+bool SerialPort::OpenPort(const QString& port_name, bool& is_bootloader) {
+    if (OpenConnection(port_name)) {
+        if (DetectBoard(is_bootloader) && (!is_bootloader || NegotiateBaudRate())) {
+            last_port_identity_ = ToPortIdentity(QSerialPortInfo(*this));
+            return true;
+        }
+
+        CloseConn();
+    }
+
     return false;
 }
 
+PortIdentity SerialPort::LastPortIdentity() const {
+    return last_port_identity_;
+}
+
+void SerialPort::SetPreferredPorts(const QVector<PortIdentity>& preferred_ports) {
+    preferred_ports_ = preferred_ports;
+}
+
+void SerialPort::SetPortFilter(const PortFilter& port_filter) {
+    port_filter_ = port_filter;
+}
+
 } // namespace communication
@@ -35,10 +35,53 @@
 #ifndef SERIAL_PORT_H_
 #define SERIAL_PORT_H_
 
+#include <functional>
 #include <QSerialPort>
+#include <QSerialPortInfo>
+#include <QVector>
+
+#include "native_serial_port.h"
 
 namespace communication {
 
+constexpr qint32 kDefaultBaudRate {QSerialPort::Baud115200};   //!< Baud rate used for board detection and as fallback
+constexpr qint32 kHighBaudRate {921600};                        //!< Baud rate proposed to the bootloader by default
+
+/*!
+ * \brief Open port with the default settings used for board detection: 115200 8N1, no flow control
+ * \param port - Port that will be opened
+ * \param port_name - Port name
+ * \return True if port is successfully opened, false otherwise
+ */
+bool OpenDefaultPort(QSerialPort& port, const QString& port_name);
+
+/*!
+ * \brief The PortFilter struct, USB descriptors of the ports that are probed for a board. Empty field accepts any port.
+ */
+struct PortFilter {
+    QVector<quint16> vendor_ids;    //!< Accepted USB vendor IDs
+    QVector<quint16> product_ids;   //!< Accepted USB product IDs
+    QString manufacturer;           //!< Part of the manufacturer string
+};
+
+/*!
+ * \brief The SerialBackend enum, implementation used for the connection to the board
+ */
+enum class SerialBackend {
+    kQt,        //!< QSerialPort
+    kNative     //!< NativeSerialPort, termios and epoll with low latency settings, Linux only
+};
+
+/*!
+ * \brief The PortIdentity struct, identifies port of a board across re-enumeration
+ */
+struct PortIdentity {
+    QString serial_number;          //!< USB serial number
+    QString system_location;        //!< System location of the port
+    quint16 vendor_id {0U};         //!< USB vendor ID
+    quint16 product_id {0U};        //!< USB product ID
+};
+
 /*!
  * \brief The SerialPort class, contains serial port information
  */
@@ -47,6 +90,11 @@ class SerialPort : public QSerialPort {
     Q_OBJECT
 
   public:
+    /*!
+     * \brief Function that checks if buffered Rx data is a complete response, data is viewed in place in the Rx buffer
+     */
+    using CompletionCheck = std::function<bool(const ByteView& rx_data)>;
+
     /*!
      * \brief SerialPort constructor
      */
@@ -70,11 +118,68 @@ class SerialPort : public QSerialPort {
     bool TryOpenPort(bool& is_bootloader);
 
     /*!
-     * \brief Wait until Rx data is ready. The method has a predefined wait value with no data on the serial line,
-     * so it is able to receive data in chunks.
+     * \brief Method used to find all ports with a board, ports are probed concurrently
+     * \return Names of the ports where board answered, sorted
+     */
+    QStringList FindBoardPorts() const;
+
+    /*!
+     * \brief Method used to open the given port and detect board on it
+     * \param port_name - Port name
+     * \param is_bootloader - Flag that determines if bootloader or firmware runs on the board
+     * \return True if port is successfully opened and board detected, false otherwise
+     */
+    bool OpenPort(const QString& port_name, bool& is_bootloader);
+
+    /*!
+     * \brief Get identity of the port where board was last detected
+     * \return Port identity, empty if board was not detected yet
+     */
+    PortIdentity LastPortIdentity() const;
+
+    /*!
+     * \brief Set ports that are probed before all the others, e.g. ports where known boards were found before
+     * \param preferred_ports - Identities of preferred ports
+     */
+    void SetPreferredPorts(const QVector<PortIdentity>& preferred_ports);
+
+    /*!
+     * \brief Wait until Rx data is ready. The method wakes up on received data and returns as soon as is_complete
+     * reports a complete response. Without is_complete, or if the response never completes, the response is considered
+     * complete after a predefined period with no new data on the serial line, so it is able to receive data in chunks.
      * \param timeout - Function timeout value
+     * \param is_complete - Function that checks if buffered data is a complete response, may be empty
      */
-    void WaitForReadyRead(int timeout);
+    void WaitForReadyRead(int timeout, const CompletionCheck& is_complete = nullptr);
+
+    /*!
+     * \brief Discard all received data that is not read yet, used before a new request is sent so a late part of a
+     * previous response is not mistaken for the new one
+     */
+    void ClearRxData();
+
+    /*!
+     * \brief Get round trip time of the last response, measured from the start of waiting until the response was
+     * complete. Waiting starts right after the request is written.
+     * \return Round trip time in [us]
+     */
+    qint64 LastRoundTripUs() const;
+
+    /*!
+     * \brief Get time needed to transfer data over the link at the baud rate currently in use, 10 bits per byte
+     * \param size - Number of bytes
+     * \return Transfer time in [ms], rounded up
+     */
+    int TransferTimeInMs(qint64 size) const;
+
+    /*!
+     * \brief Wait until at least the given number of bytes is buffered. Unlike WaitForReadyRead() it returns as soon as
+     * enough data has arrived, so it is used when the size of the expected reply is known in advance.
+     * \param size - Number of bytes to wait for
+     * \param timeout - Function timeout value
+     * \return True if requested number of bytes is available, false on timeout
+     */
+    bool WaitForBytes(int size, int timeout);
 
     /*!
      * \brief Method used to copy data to a given reference. After data is copied internal buffer will be cleared.
@@ -82,6 +187,74 @@ class SerialPort : public QSerialPort {
      */
     void ReadData(QByteArray& data_out);
 
+    /*!
+     * \brief Method used to copy the given number of bytes to a given reference. Copied data is removed from the internal
+     * buffer while the rest stays buffered.
+     * \param data_out - Reference to output data
+     * \param size - Number of bytes to copy
+     */
+    void ReadData(QByteArray& data_out, int size);
+
+    /*!
+     * \brief Method used to remove the given number of bytes from the internal buffer without copying them, used
+     * after data is parsed in place with PeekData()
+     * \param size - Number of bytes to remove
+     */
+    void DiscardData(int size);
+
+    /*!
+     * \brief Get number of bytes that are received and not yet read
+     * \return Number of buffered bytes
+     */
+    int RxDataSize() const;
+
+    /*!
+     * \brief Get data that is received and not yet read, without removing it from the internal buffer
+     * \return View of buffered data, valid until data is received, read or discarded
+     */
+    ByteView PeekData();
+
+    /*!
+     * \brief Set link settings proposed to the bootloader once it is detected
+     * \param baud_rate - Baud rate, kDefaultBaudRate or lower disables baud rate negotiation
+     * \param is_hardware_flow_control_enabled - Use RTS/CTS flow control at the negotiated baud rate
+     */
+    void SetLinkSettings(qint32 baud_rate, bool is_hardware_flow_control_enabled);
+
+    /*!
+     * \brief Set filter of the ports that are probed when trying to open port
+     * \param port_filter - Port filter
+     */
+    void SetPortFilter(const PortFilter& port_filter);
+
+    /*!
+     * \brief Select implementation used for the connection to the board, open connection is closed. Board detection on
+     * all ports always uses QSerialPort, selected backend is used once the board is found.
+     * \param backend - Serial backend
+     */
+    void SetBackend(SerialBackend backend);
+
+    /*!
+     * \brief Check if connection to the board is open
+     * \return True if port is open, false otherwise
+     */
+    bool IsOpen() const;
+
+    /*!
+     * \brief Write data to the board
+     * \param data - Data
+     * \param size - Data size in [B]
+     * \return Number of written bytes, -1 on error
+     */
+    qint64 Write(const char *data, qint64 size);
+
+    /*!
+     * \brief Write data to the board
+     * \param data - Data
+     * \return Number of written bytes, -1 on error
+     */
+    qint64 Write(const QByteArray& data);
+
   public slots:
     /*!
      * \brief ReadyRead slot
@@ -96,6 +269,45 @@ class SerialPort : public QSerialPort {
      */
     bool DetectBoard(bool& is_bootloader);
 
+    /*!
+     * \brief Method used to switch detected bootloader to the configured baud rate. Probe confirms the link after both
+     * sides switch, otherwise default baud rate is restored.
+     * \return True if bootloader is reachable after negotiation, false otherwise
+     */
+    bool NegotiateBaudRate();
+
+    /*!
+     * \brief Method used to check if port matches the port filter
+     * \param info - Port information
+     * \return True if port should be probed, false otherwise
+     */
+    bool IsPortAccepted(const QSerialPortInfo& info) const;
+
+    /*!
+     * \brief Method used to probe ports concurrently, each probe uses its own temporary port. First port that
+     * answers with software type wins and remaining probes are stopped.
+     * \param port_names - Names of the ports that will be probed
+     * \param detected_port_name - Name of the port where board is detected
+     * \param is_bootloader - Flag that determines if bootloader or firmware runs on the board
+     * \return True if board is detected, false otherwise
+     */
+    bool ProbePorts(const QStringList& port_names, QString& detected_port_name, bool& is_bootloader) const;
+
+    /*!
+     * \brief Method used to check if port is the last used port or one of the preferred ports
+     * \param info - Port information
+     * \return True if port is preferred, false otherwise
+     */
+    bool IsPreferredPort(const QSerialPortInfo& info) const;
+
+    /*!
+     * \brief Method used to probe given ports and open the port where board is detected
+     * \param infos - Information of the ports that will be probed
+     * \param is_bootloader - Flag that determines if bootloader or firmware runs on the board
+     * \return True if port is successfully opened, false otherwise
+     */
+    bool OpenDetectedPort(const QList<QSerialPortInfo>& infos, bool& is_bootloader);
+
     /*!
      * \brief Method used to open connection
      * \param port_name - Port name
@@ -103,8 +315,42 @@ class SerialPort : public QSerialPort {
      */
     bool OpenConnection(const QString& port_name);
 
-    QByteArray serial_rx_data_;     //!< Byte Array work as an Rx buffer
-    int previous_rx_data_size_{0};  //!< Previous Rx data size
+    /*!
+     * \brief Method used to change link settings of the open connection
+     * \param baud_rate - Baud rate
+     * \param is_hardware_flow_control_enabled - Use RTS/CTS flow control
+     */
+    void ApplyLinkSettings(qint32 baud_rate, bool is_hardware_flow_control_enabled);
+
+    /*!
+     * \brief Method used to wait for new Rx data and append it to the internal buffer
+     * \param timeout - Timeout in [ms]
+     * \return True if new data is buffered, false otherwise
+     */
+    bool WaitForRxData(int timeout);
+
+    /*!
+     * \brief Method used to get Rx buffer of the selected backend
+     * \return Reference to the Rx buffer
+     */
+    RingBuffer& RxBuffer();
+
+    /*!
+     * \brief Method used to get Rx buffer of the selected backend
+     * \return Reference to the Rx buffer
+     */
+    const RingBuffer& RxBuffer() const;
+
+    RingBuffer rx_buffer_;                          //!< Rx buffer of the QSerialPort backend, native port has its own
+    qint64 last_round_trip_us_{0};                  //!< Round trip time of the last response in [us]
+    qint32 baud_rate_{kHighBaudRate};               //!< Baud rate proposed to the bootloader
+    qint32 link_baud_rate_{kDefaultBaudRate};       //!< Baud rate of the open connection
+    bool is_hardware_flow_control_enabled_{false};  //!< Use RTS/CTS flow control at the negotiated baud rate
+    PortFilter port_filter_;                        //!< Filter of the ports that are probed
+    PortIdentity last_port_identity_;               //!< Port where board was last detected
+    QVector<PortIdentity> preferred_ports_;         //!< Ports that are probed first
+    SerialBackend backend_{SerialBackend::kQt};     //!< Implementation used for the connection to the board
+    NativeSerialPort native_port_;                  //!< Connection used by the native backend
 };
 
 } // namespace communication
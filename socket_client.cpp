@@ -33,13 +33,18 @@
  ****************************************************************************/
 
 #include "socket_client.h"
-#include "crc32.h"
 
 #include <QHostAddress>
+#include <QHostInfo>
 #include <QMessageAuthenticationCode>
 #include <QJsonDocument>
 #include <QElapsedTimer>
 #include <QThread>
+#include <QtEndian>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 namespace socket {
 
@@ -52,6 +57,27 @@ constexpr int kMaxNoDataRetry {150};    //!< Max number of retries with no data
 #endif
 constexpr int kMaxNoDataPeriod {1};     //!< Max time in [ms] while waiting
 constexpr qint64 kSocketTimeout {2000};
+constexpr int kDownloadChunkSize {64 * 1024};                  //!< Size of the chunks delivered to the download consumer
+constexpr qint64 kDownloadReadBufferSize {4 * kDownloadChunkSize};  //!< Max data buffered by the socket while downloading, server is throttled by TCP
+constexpr int kProtocolVersion {2};             //!< Version with length-prefixed framing
+constexpr char kLengthPrefixedFraming[] = "length_prefixed";
+constexpr int kLengthPrefixSize {4};            //!< Big-endian message length in front of every framed message
+constexpr qint64 kMaxMessageSize {0xFFFFFF};    //!< Max size of a framed message other than the file, first byte of its prefix is always 0
+constexpr int kSessionIdleTimeout {30000};      //!< Time in [ms] authenticated session is kept open without requests
+constexpr int kConnectStagger {250};            //!< Time in [ms] given to a server to connect before the next one is started
+
+// Value of the first size bytes of the length prefix
+qint64 PeekLengthPrefix(const communication::RingBuffer& buffer, int size) {
+    qint64 length = 0;
+    for (int i = 0; i < size; ++i) {
+        length = (length << 8) | static_cast<uint8_t>(buffer.At(i));
+    }
+    return length;
+}
+
+QString ToServerKey(const QString& server_address, int server_port) {
+    return server_address + ':' + QString::number(server_port);
+}
 
 } // namespace
 
@@ -59,18 +85,40 @@ SocketClient::SocketClient(QJsonArray servers_array) :
     servers_array_(std::move(servers_array)) {
 
     connect(this, &socket::SocketClient::readyRead, this, &socket::SocketClient::ReadyRead);
+
+    idle_timer_.setSingleShot(true);
+    idle_timer_.setInterval(kSessionIdleTimeout);
+    connect(&idle_timer_, &QTimer::timeout, this, &socket::SocketClient::CloseSession);
+
+    // Timer is a child so it moves together with the socket when download runs in another thread
+    idle_timer_.setParent(this);
+
+    ResolveServerAddresses();
 }
 
 SocketClient::~SocketClient() = default;
 
 void SocketClient::ReadyRead() {
-    socket_rx_data_.append(readAll());
+    // Data is read straight into the free space of the Rx buffer
+    socket_rx_data_.ReserveFreeSpace(static_cast<int>(bytesAvailable()));
 
-    retry_number_ = 0;
+    communication::RingBuffer::Span spans[2];
+    socket_rx_data_.GetFreeSpans(spans[0], spans[1]);
+
+    for (const auto& span : spans) {
+        const qint64 size = (span.size > 0) ? read(span.data, span.size) : 0;
+        if (size <= 0) {
+            break;
+        }
 
-    if (emit_progress) {
-        emit DownloadProgress(socket_rx_data_.size(), file_size_);
+        socket_rx_data_.Commit(static_cast<int>(size));
+        is_response_received_ = true;
+        if (size < span.size) {
+            break;
+        }
     }
+
+    retry_number_ = 0;
 }
 
 bool SocketClient::WaitForReadyRead(int timeout = 0) {
@@ -84,7 +132,7 @@ bool SocketClient::WaitForReadyRead(int timeout = 0) {
         QObject().thread()->msleep(kMaxNoDataPeriod); // Give some time to the sender to send the data
         waitForReadyRead(1); //known workaround for triggering readyRead signal(https://bugreports.qt.io/browse/QTBUG-78086)
 
-        int current_rx_data_size = socket_rx_data_.size();
+        int current_rx_data_size = socket_rx_data_.Size();
         if ((retry_number_ >= kMaxNoDataRetry) && (current_rx_data_size == previous_rx_data_size_) && (current_rx_data_size != 0)) {
             // No new data. Ready to read, exit the loop.
             success = true;
@@ -102,28 +150,246 @@ bool SocketClient::WaitForReadyRead(int timeout = 0) {
 }
 
 void SocketClient::ReadData(QByteArray& data_out) {
-    data_out = socket_rx_data_;
-    socket_rx_data_.clear();
+    data_out = socket_rx_data_.Take(socket_rx_data_.Size());
+    previous_rx_data_size_ = 0;
+}
+
+bool SocketClient::RunInSession(const std::function<bool()>& request) {
+    const bool is_session_reused = IsSessionOpen();
+    is_response_received_ = false;
+
+    bool success = (is_session_reused || Connect()) && request();
+
+    if (!success && is_session_reused && !is_response_received_) {
+        // Server dropped the session without an answer, request is repeated on a new connection
+        qInfo() << "Server " << server_address_ << " does not keep the session open";
+        sessionless_servers_.insert(ServerKey());
+        CloseSession();
+        success = Connect() && request();
+    }
+
+    if (success && !sessionless_servers_.contains(ServerKey())) {
+        idle_timer_.start();
+    } else {
+        CloseSession();
+    }
+
+    return success;
+}
+
+bool SocketClient::IsSessionOpen() {
+    // Timer is checked directly as well, timeout is not delivered while requests are blocking the event loop
+    if (!idle_timer_.isActive() || (idle_timer_.remainingTime() == 0)) {
+        return false;
+    }
+
+    // Pending data lets socket notice if server closed the connection, leftovers of previous request are dropped
+    waitForReadyRead(0);
+    ReadyRead();
+    socket_rx_data_.Clear();
     previous_rx_data_size_ = 0;
+
+    return state() == ConnectedState;
+}
+
+void SocketClient::CloseSession() {
+    idle_timer_.stop();
+
+    if (state() == ConnectedState) {
+        disconnectFromHost();
+    } else if (state() != UnconnectedState) {
+        abort();
+    }
+}
+
+void SocketClient::SetServerRtts(const QHash<QString, int>& server_rtts) {
+    server_rtts_ = server_rtts;
+}
+
+QHash<QString, int> SocketClient::ServerRtts() const {
+    return server_rtts_;
+}
+
+void SocketClient::SetLegacyServers(const QSet<QString>& legacy_servers) {
+    legacy_servers_ = legacy_servers;
+}
+
+QSet<QString> SocketClient::LegacyServers() const {
+    return legacy_servers_;
+}
+
+void SocketClient::ResolveServerAddresses() {
+    foreach (const QJsonValue& server, servers_array_) {
+        const QString server_address = server.toObject()["address"].toString();
+        if (QHostAddress(server_address).isNull()) {
+            QHostInfo::lookupHost(server_address, this, [this, server_address](const QHostInfo& host_info) {
+                if (!host_info.addresses().isEmpty()) {
+                    resolved_addresses_.insert(server_address, host_info.addresses().first());
+                }
+            });
+        }
+    }
+}
+
+QHostAddress SocketClient::ResolveAddress(const QString& server_address) {
+    QHostAddress address(server_address);
+
+    if (address.isNull()) {
+        address = resolved_addresses_.value(server_address);
+    }
+
+    if (address.isNull()) {
+        const QHostInfo host_info = QHostInfo::fromName(server_address);
+        if (!host_info.addresses().isEmpty()) {
+            address = host_info.addresses().first();
+            resolved_addresses_.insert(server_address, address);
+        }
+    }
+
+    return address;
+}
+
+QVector<int> SocketClient::RaceServers() {
+    struct Probe {
+        int index;                                  //!< Server index
+        QString key;                                //!< Server key
+        QAbstractSocket *socket;                    //!< Socket that connects, this socket or an owned one
+        std::unique_ptr<QTcpSocket> owned_socket;   //!< Socket used only to measure connect time
+        QElapsedTimer timer;                        //!< Connect time
+        bool is_failed;                             //!< Connect failed
+    };
+
+    // Unknown servers are tried early so they get measured, servers with the same RTT keep the configured order
+    QVector<int> ranking;
+    for (int i = 0; i < servers_array_.size(); ++i) {
+        ranking.append(i);
+    }
+
+    auto server_key = [this](int index) {
+        const QJsonObject server = servers_array_.at(index).toObject();
+        return ToServerKey(server["address"].toString(), server["port"].toInt());
+    };
+    std::stable_sort(ranking.begin(), ranking.end(), [this, &server_key](int left, int right) {
+        return server_rtts_.value(server_key(left), 0) < server_rtts_.value(server_key(right), 0);
+    });
+
+    // There is nothing to race with a single server
+    if (ranking.size() < 2) {
+        return ranking;
+    }
+
+    std::vector<Probe> probes;
+    int failed_count = 0;
+    int winner = -1;
+    QElapsedTimer race_timer;
+    race_timer.start();
+
+    while ((winner < 0) && !race_timer.hasExpired(kSocketTimeout)) {
+        const bool is_all_failed = (failed_count == static_cast<int>(probes.size()));
+        const bool is_all_started = (static_cast<int>(probes.size()) == ranking.size());
+
+        if (is_all_started && is_all_failed) {
+            break;
+        }
+
+        // Next server is started right away when all started ones failed
+        if (!is_all_started && (is_all_failed || (race_timer.elapsed() >= static_cast<qint64>(probes.size()) * kConnectStagger))) {
+            const int index = ranking.at(static_cast<int>(probes.size()));
+            const QJsonObject server = servers_array_.at(index).toObject();
+
+            // Best ranked server is connected by this socket, so the connection is kept when it wins as expected
+            std::unique_ptr<QTcpSocket> owned_socket;
+            QAbstractSocket *socket = this;
+            if (probes.empty()) {
+                abort();
+            } else {
+                owned_socket = std::make_unique<QTcpSocket>();
+                socket = owned_socket.get();
+            }
+
+            probes.push_back(Probe{index, server_key(index), socket, std::move(owned_socket), QElapsedTimer(), false});
+            probes.back().timer.start();
+
+            const QHostAddress address = ResolveAddress(server["address"].toString());
+            if (address.isNull()) {
+                probes.back().is_failed = true;
+                ++failed_count;
+            } else {
+                probes.back().socket->connectToHost(address, static_cast<quint16>(server["port"].toInt()));
+            }
+        }
+
+        for (auto& probe : probes) {
+            if (probe.is_failed) {
+                continue;
+            }
+
+            probe.socket->QAbstractSocket::waitForConnected(kMaxNoDataPeriod);
+
+            if (probe.socket->state() == ConnectedState) {
+                server_rtts_.insert(probe.key, static_cast<int>(probe.timer.elapsed()));
+                winner = probe.index;
+                break;
+            }
+
+            if (probe.socket->state() == UnconnectedState) {
+                probe.is_failed = true;
+                ++failed_count;
+            }
+        }
+    }
+
+    // Connection of this socket is dropped when another server won, winner is connected again
+    if (!probes.empty() && (probes.front().index != winner)) {
+        abort();
+    }
+
+    // Failed servers go to the end of the ranking next time, failed address is looked up again
+    for (const auto& probe : probes) {
+        if (probe.is_failed) {
+            server_rtts_.insert(probe.key, static_cast<int>(kSocketTimeout));
+            resolved_addresses_.remove(servers_array_.at(probe.index).toObject()["address"].toString());
+        }
+    }
+
+    // Winner is tried first, servers that failed are tried again only if none connected. Servers that did not connect
+    // during the whole race are not worth another timeout.
+    QVector<int> candidates;
+    if (winner >= 0) {
+        candidates.append(winner);
+    }
+
+    for (const int index : ranking) {
+        auto probe = std::find_if(probes.begin(), probes.end(), [index](const Probe& item) { return item.index == index; });
+        const bool is_pending = (probe != probes.end()) && !probe->is_failed;
+        const bool is_failed = (probe != probes.end()) && probe->is_failed;
+
+        if ((index != winner) && !(is_pending && (winner < 0)) && !(is_failed && (winner >= 0))) {
+            candidates.append(index);
+        }
+    }
+
+    return candidates;
 }
 
 bool SocketClient::Connect() {
     bool success = false;
 
-    foreach (const QJsonValue& server, servers_array_) {
-        QJsonObject obj = server.toObject();
+    CloseSession();
+
+    foreach (const int index, RaceServers()) {
+        QJsonObject obj = servers_array_.at(index).toObject();
         server_address_ = obj["address"].toString();
         server_port_ = obj["port"].toInt();
         preshared_key_ = obj["preshared_key"].toString().toUtf8();
 
-        if (state() == UnconnectedState) {
-            connectToHost(server_address_, server_port_);
-
-            if (waitForConnected(kSocketTimeout) && Authentication()) {
+        // Only the race winner can be connected already
+        if ((state() == UnconnectedState) || (state() == ConnectedState)) {
+            // Older server may close the connection on capability request, it is connected again without the request
+            const bool is_legacy_server = legacy_servers_.contains(ServerKey());
+            if (ConnectToServer() || (!is_legacy_server && legacy_servers_.contains(ServerKey()) && ConnectToServer())) {
                 success = true;
                 break;
-            } else {
-                disconnectFromHost();
             }
         }
     }
@@ -131,12 +397,118 @@ bool SocketClient::Connect() {
     return success;
 }
 
-bool SocketClient::Disconnect() {
-    if (state() == ConnectedState) {
-        disconnectFromHost();
+bool SocketClient::ConnectToServer() {
+    is_framing_enabled_ = false;
+    socket_rx_data_.Clear();
+    previous_rx_data_size_ = 0;
+
+    // Connection that won the server race is reused
+    if (state() != ConnectedState) {
+        const QHostAddress address = ResolveAddress(server_address_);
+        if (address.isNull()) {
+            connectToHost(server_address_, server_port_);
+        } else {
+            connectToHost(address, server_port_);
+        }
     }
 
-    return (state() != ConnectedState);
+    if (waitForConnected(kSocketTimeout) && Authentication() && NegotiateFraming()) {
+        return true;
+    }
+
+    disconnectFromHost();
+    return false;
+}
+
+bool SocketClient::NegotiateFraming() {
+    if ((state() != ConnectedState) || legacy_servers_.contains(ServerKey())) {
+        return true;
+    }
+
+    QJsonObject packet_object;
+    packet_object.insert("header", kHeaderClientCapabilities);
+    packet_object.insert("protocol_version", kProtocolVersion);
+    packet_object.insert("framing", kLengthPrefixedFraming);
+
+    // Connection that can not take the request is not usable for the next one either
+    if (!WriteMessage(QJsonDocument(packet_object).toJson())) {
+        return false;
+    }
+
+    // Server that knows the request answers with a framed message, text answer is rejected on its first byte
+    QByteArray reply;
+    if (ReadFrame(reply, kMaxMessageSize)) {
+        const QJsonObject reply_object = QJsonDocument::fromJson(reply).object();
+        is_framing_enabled_ = (reply_object.value("header").toString() == kHeaderServerCapabilities) &&
+                              (reply_object.value("framing").toString() == kLengthPrefixedFraming);
+        return true;
+    }
+
+    // Older server does not know the request, its answer is dropped and it is not asked again
+    qInfo() << "Server " << server_address_ << " does not support framing";
+    legacy_servers_.insert(ServerKey());
+    if (!socket_rx_data_.IsEmpty()) {
+        WaitForReadyRead(kSocketTimeout);
+        socket_rx_data_.Clear();
+        previous_rx_data_size_ = 0;
+    }
+
+    return state() == ConnectedState;
+}
+
+QString SocketClient::ServerKey() const {
+    return ToServerKey(server_address_, server_port_);
+}
+
+bool SocketClient::WriteMessage(const QByteArray& data) {
+    if (is_framing_enabled_) {
+        const quint32 length_prefix = qToBigEndian(static_cast<quint32>(data.size()));
+        write(reinterpret_cast<const char *>(&length_prefix), kLengthPrefixSize);
+    }
+
+    return (write(data) == data.size()) && waitForBytesWritten();
+}
+
+bool SocketClient::ReadFrame(QByteArray& out_data, qint64 max_size) {
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!timer.hasExpired(kSocketTimeout)) {
+        // Length is checked as soon as its first bytes arrive, so data that is not a frame is rejected right away
+        const int prefix_size = qMin(socket_rx_data_.Size(), kLengthPrefixSize);
+        const qint64 length = PeekLengthPrefix(socket_rx_data_, prefix_size);
+        if (length > (max_size >> (8 * (kLengthPrefixSize - prefix_size)))) {
+            return false;
+        }
+
+        // Message is complete as soon as the declared number of bytes is here, there is no waiting for a pause
+        if ((prefix_size == kLengthPrefixSize) && ((socket_rx_data_.Size() - kLengthPrefixSize) >= length)) {
+            socket_rx_data_.Consume(kLengthPrefixSize);
+            out_data = socket_rx_data_.Take(static_cast<int>(length));
+            return true;
+        }
+
+        waitForReadyRead(kMaxNoDataPeriod);
+        ReadyRead();    // readyRead signal is not always emitted by waitForReadyRead (https://bugreports.qt.io/browse/QTBUG-78086)
+    }
+
+    return false;
+}
+
+bool SocketClient::WaitForRxDataSize(int size) {
+    QElapsedTimer timer;
+    timer.start();
+
+    while (socket_rx_data_.Size() < size) {
+        if (timer.hasExpired(kSocketTimeout)) {
+            return false;
+        }
+
+        waitForReadyRead(kMaxNoDataPeriod);
+        ReadyRead();    // readyRead signal is not always emitted by waitForReadyRead (https://bugreports.qt.io/browse/QTBUG-78086)
+    }
+
+    return true;
 }
 
 bool SocketClient::Authentication() {
@@ -144,6 +516,7 @@ bool SocketClient::Authentication() {
     QMessageAuthenticationCode code(QCryptographicHash::Sha256);
     code.setKey(preshared_key_);
 
+    // Framing is negotiated after authentication and token size is not fixed, token is read until the server pauses
     QByteArray token;
     success = ReadAll(token);
     if (success) {
@@ -157,6 +530,9 @@ bool SocketClient::Authentication() {
 }
 
 bool SocketClient::ReadAll(QByteArray& out_data) {
+    if (is_framing_enabled_) {
+        return ReadFrame(out_data, kMaxMessageSize);
+    }
 
     bool success = WaitForReadyRead(kSocketTimeout);
     if (success) {
@@ -167,11 +543,9 @@ bool SocketClient::ReadAll(QByteArray& out_data) {
 }
 
 bool SocketClient::SendDataWithAck(const QByteArray& in_data) {
-    bool success = false;
-    qint64 size = write(in_data);
-    success = waitForBytesWritten();
+    bool success = WriteMessage(in_data);
 
-    if (success && in_data.size() == size) {
+    if (success) {
         success = CheckAck();
     }
 
@@ -191,15 +565,25 @@ bool SocketClient::RequestData() {
     QJsonDocument json_doc;
     json_doc.setObject(packet_object);
 
-    QByteArray data = json_doc.toJson();
-    write(data);
-    return waitForBytesWritten();
+    return WriteMessage(json_doc.toJson());
 }
 
 bool SocketClient::CheckAck() {
     bool success = false;
 
     QByteArray ack;
+    if (!is_framing_enabled_) {
+        // Unframed ACK is complete as soon as its bytes are here, any other answer is read until the server pauses
+        if (!WaitForRxDataSize(kAck.size())) {
+            return false;
+        }
+
+        if (socket_rx_data_.Size() == kAck.size()) {
+            ReadData(ack);
+            return kAck == ack;
+        }
+    }
+
     success = ReadAll(ack);
 
     if (success && (kAck != ack)) {
@@ -210,10 +594,7 @@ bool SocketClient::CheckAck() {
 }
 
 bool SocketClient::SendBoardInfo(QJsonObject board_info, QJsonObject bl_sw_info, QJsonObject fw_sw_info) {
-    bool success = Connect();
-
-    if (success) {
-
+    return RunInSession([&]() {
         QJsonObject app_sw_info;
         app_sw_info.insert("app_branch", GIT_BRANCH);
         app_sw_info.insert("app_hash", GIT_HASH);
@@ -226,122 +607,185 @@ bool SocketClient::SendBoardInfo(QJsonObject board_info, QJsonObject bl_sw_info,
         packet_object.insert("fw_sw_info", fw_sw_info);
         packet_object.insert("app_sw_info", app_sw_info);
 
-        success = SendQJsonObject(packet_object);
+        const bool success = SendQJsonObject(packet_object);
 
         if (success) {
             qInfo() << "Board info updated to server " << server_address_;
         }
-    }
-
-    Disconnect();
 
-    return success;
+        return success;
+    });
 }
 
 bool SocketClient::ReceiveProductInfo(QJsonObject board_info, QJsonObject bl_sw_info, QJsonArray& product_info, bool& is_secure_communication) {
-    bool success = Connect();
+    return RunInSession([&]() {
+        QJsonObject request_object;
+        request_object.insert("header", kHeaderClientProductInfo);
+        request_object.insert("board_info", board_info);
+        request_object.insert("bl_sw_info", bl_sw_info);
 
-    if (success) {
-        QJsonObject packet_object;
-        packet_object.insert("header", kHeaderClientProductInfo);
-        packet_object.insert("board_info", board_info);
-        packet_object.insert("bl_sw_info", bl_sw_info);
-
-        success = SendQJsonObject(packet_object);
-    }
+        bool success = SendQJsonObject(request_object);
 
-    if (success) {
+        if (success) {
 
-        success = RequestData(); // request JSON with product info
+            success = RequestData(); // request JSON with product info
 
-        if (success) {
+            if (success) {
 
-            QByteArray data;
-            success = ReadAll(data);
+                QByteArray data;
+                success = ReadAll(data);
 
-            QJsonDocument json_data = QJsonDocument::fromJson(data);
-            QJsonObject packet_object = json_data.object();
+                QJsonDocument json_data = QJsonDocument::fromJson(data);
+                QJsonObject packet_object = json_data.object();
 
-            if (packet_object.value("header").toString() == kHeaderServerProductInfo) {
-                product_info = packet_object.value("product_info").toArray();
-                is_secure_communication = packet_object.value("secure_communication").toBool();
-            } else {
-                success = false;
+                if (packet_object.value("header").toString() == kHeaderServerProductInfo) {
+                    product_info = packet_object.value("product_info").toArray();
+                    is_secure_communication = packet_object.value("secure_communication").toBool();
+                } else {
+                    success = false;
+                }
             }
         }
-    }
 
-    Disconnect();
-
-    return success;
+        return success;
+    });
 }
 
-bool SocketClient::DownloadFile(const QJsonObject board_info, const QJsonObject client_security_data, const QString file_version, QJsonObject& server_security_data, QByteArray& file) {
+bool SocketClient::DownloadFile(const QJsonObject board_info, const QJsonObject client_security_data, const QString file_version, QJsonObject& server_security_data, QByteArray& file, const FileHeaderHandler& handle_file_header) {
+    file.clear();
 
-    qint32 file_crc;
+    return DownloadFileStream(board_info, client_security_data, file_version, server_security_data, [this, &file](const char *chunk, int size) {
+        if (file.isEmpty()) {
+            file.reserve(file_size_);
+        }
+        file.append(chunk, size);
+        return true;
+    }, handle_file_header);
+}
 
-    bool success = Connect();
+bool SocketClient::DownloadFileStream(const QJsonObject board_info, const QJsonObject client_security_data, const QString file_version, QJsonObject& server_security_data, const ChunkConsumer& consume_chunk, const FileHeaderHandler& handle_file_header) {
+    bool is_file_needed = true;
 
-    if (success) {
-        QJsonObject packet_object;
-        packet_object.insert("header", kHeaderClientDownloadFile);
-        packet_object.insert("board_info", board_info);
-        packet_object.insert("file_version", file_version);
-        packet_object.insert("client_security_data", client_security_data);
+    const bool success = RunInSession([&]() {
+        qint32 file_crc;
 
-        QJsonDocument json_data;
-        json_data.setObject(packet_object);
-        success = SendDataWithAck(json_data.toJson());
-    }
+        QJsonObject request_object;
+        request_object.insert("header", kHeaderClientDownloadFile);
+        request_object.insert("board_info", board_info);
+        request_object.insert("file_version", file_version);
+        request_object.insert("client_security_data", client_security_data);
 
-    if (success) {
+        QJsonDocument request_json;
+        request_json.setObject(request_object);
+        bool success = SendDataWithAck(request_json.toJson());
 
-        QByteArray data;
+        if (success) {
 
-        success = RequestData(); // request JSON with file info
+            QByteArray data;
 
-        if (success) {
-            success = ReadAll(data);
-        }
+            success = RequestData(); // request JSON with file info
 
-        QJsonDocument json_data = QJsonDocument::fromJson(data);
-        QJsonObject packet_object = json_data.object();
+            if (success) {
+                success = ReadAll(data);
+            }
 
-        if (packet_object.value("header").toString() == kHeaderServerDownloadFile) {
+            QJsonDocument json_data = QJsonDocument::fromJson(data);
+            QJsonObject packet_object = json_data.object();
 
-            file_crc = packet_object.value("file_crc").toInt();
-            file_size_ = packet_object.value("file_size").toInt();
-            server_security_data = packet_object.value("server_security_data").toObject();
+            if (packet_object.value("header").toString() == kHeaderServerDownloadFile) {
 
-        } else {
-            success = false;
+                file_crc = packet_object.value("file_crc").toInt();
+                file_size_ = packet_object.value("file_size").toInt();
+                server_security_data = packet_object.value("server_security_data").toObject();
+
+            } else {
+                success = false;
+            }
         }
-    }
 
-    if (success) {
-        emit_progress = true;
-        success = RequestData(); // request file
+        is_file_needed = true;
+        if (success && handle_file_header) {
+            is_file_needed = handle_file_header(file_size_, static_cast<quint32>(file_crc));
+        }
 
-        if (success) {
-            success = ReadAll(file);
+        if (success && is_file_needed) {
+            crc::InitCrc32(file_crc_, false, false);
+            // Socket stops reading from the network when its buffer is full, so memory use does not depend on file size
+            setReadBufferSize(kDownloadReadBufferSize);
+            success = RequestData(); // request file
 
             if (success) {
+                success = ReceiveFile(consume_chunk);
 
-                const uint8_t *data = reinterpret_cast<const uint8_t *>(file.data());
-                qint32 crc = crc::CalculateCrc32(data, file.size(), false, false);
+                if (success) {
+                    // CRC is already calculated as chunks arrived
+                    qint32 crc = crc::FinalizeCrc32(file_crc_);
 
-                if ((file.size() != file_size_) || (crc != file_crc)) {
-                    success = false;
+                    if ((file_crc_.length != static_cast<uint64_t>(file_size_)) || (crc != file_crc)) {
+                        success = false;
+                    }
                 }
             }
+
+            setReadBufferSize(0);
+            socket_rx_data_.Clear();
         }
 
-        emit_progress = false;
-    }
+        return success;
+    });
 
-    Disconnect();
+    // Server still holds the file that was not requested, session can not take the next request
+    if (!is_file_needed) {
+        CloseSession();
+    }
 
     return success;
 }
 
+bool SocketClient::ReceiveFile(const ChunkConsumer& consume_chunk) {
+    qint64 delivered_size = 0;
+    bool is_length_prefix_pending = is_framing_enabled_;
+    QElapsedTimer no_data_timer;
+    no_data_timer.start();
+
+    while (delivered_size < file_size_) {
+        if (no_data_timer.hasExpired(kSocketTimeout)) {
+            return false;
+        }
+
+        const int buffered_size = socket_rx_data_.Size();
+        waitForReadyRead(kMaxNoDataPeriod);
+        ReadyRead();    // readyRead signal is not always emitted by waitForReadyRead (https://bugreports.qt.io/browse/QTBUG-78086)
+        if (socket_rx_data_.Size() != buffered_size) {
+            no_data_timer.restart();
+        }
+
+        // Framed file is one message, its length has to match the announced file size
+        if (is_length_prefix_pending && (socket_rx_data_.Size() >= kLengthPrefixSize)) {
+            if (PeekLengthPrefix(socket_rx_data_, kLengthPrefixSize) != file_size_) {
+                return false;
+            }
+            socket_rx_data_.Consume(kLengthPrefixSize);
+            is_length_prefix_pending = false;
+        }
+
+        // Full chunks are delivered as they fill up, the last chunk holds the rest of the file
+        int chunk_size = is_length_prefix_pending ? 0 : static_cast<int>(qMin<qint64>(kDownloadChunkSize, file_size_ - delivered_size));
+        while ((chunk_size > 0) && (socket_rx_data_.Size() >= chunk_size)) {
+            const char *chunk = socket_rx_data_.View().data;
+            crc::UpdateCrc32(file_crc_, reinterpret_cast<const uint8_t *>(chunk), static_cast<uint32_t>(chunk_size));
+            if (!consume_chunk(chunk, chunk_size)) {
+                return false;
+            }
+
+            socket_rx_data_.Consume(chunk_size);
+            delivered_size += chunk_size;
+            emit DownloadProgress(delivered_size, file_size_);
+            chunk_size = static_cast<int>(qMin<qint64>(kDownloadChunkSize, file_size_ - delivered_size));
+        }
+    }
+
+    return true;
+}
+
 } // namespace socket
@@ -35,10 +35,19 @@
 #ifndef SOCKET_H_
 #define SOCKET_H_
 
+#include <functional>
 #include <QByteArray>
 #include <QTcpSocket>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+#include "crc32.h"
+#include "ring_buffer.h"
 
 namespace socket {
 
@@ -50,6 +59,8 @@ const QString kHeaderServerProductInfo{"server_product_info"};
 const QString kHeaderClientDownloadFile{"client_download_file"};
 const QString kHeaderServerDownloadFile{"server_download_file"};
 const QString kHeaderClientRequestData{"client_request_data"};
+const QString kHeaderClientCapabilities{"client_capabilities"};
+const QString kHeaderServerCapabilities{"server_capabilities"};
 
 } // namespace
 
@@ -61,6 +72,18 @@ class SocketClient : public QTcpSocket {
     Q_OBJECT
 
   public:
+    /*!
+     * \brief Function that receives downloaded file chunk by chunk, returns false to abort the download. Chunk is valid
+     * only during the call. Data is not verified until the download returns true.
+     */
+    using ChunkConsumer = std::function<bool(const char *chunk, int size)>;
+
+    /*!
+     * \brief Function that receives file size and CRC as soon as the server announces them, before the file is
+     * requested. It returns false if file content is not needed, e.g. file is already cached.
+     */
+    using FileHeaderHandler = std::function<bool(qint64 file_size, quint32 file_crc)>;
+
     /*!
      * \brief SocketClient constructor
      * \param servers_array - Json array with servers config
@@ -98,11 +121,69 @@ class SocketClient : public QTcpSocket {
      * \param file_version - File version to download
      * \param server_security_data - Json object to getting security data from the server
      * \param file_content - Reference to file_content to download
-     * \return
+     * \param handle_file_header - Optional function that receives file header and decides if file is downloaded
+     * \return True if whole file is received and its CRC matches or file is not needed, false otherwise
      */
-    virtual bool DownloadFile(const QJsonObject board_info, const QJsonObject client_security_data, const QString file_version, QJsonObject& server_security_data, QByteArray& file_content);
+    virtual bool DownloadFile(const QJsonObject board_info, const QJsonObject client_security_data, const QString file_version, QJsonObject& server_security_data, QByteArray& file_content, const FileHeaderHandler& handle_file_header = FileHeaderHandler());
+
+    /*!
+     * \brief Download file from the server and deliver it in fixed size chunks as it arrives, the last chunk may be
+     * shorter. CRC is updated as data arrives and memory use does not depend on the file size.
+     * \param board_info - Json object with board info from server
+     * \param client_security_data - Json object to sending security data from the client
+     * \param file_version - File version to download
+     * \param server_security_data - Json object to getting security data from the server
+     * \param consume_chunk - Function that receives file chunks
+     * \param handle_file_header - Optional function that receives file header and decides if file is downloaded. File
+     * that is not needed is not requested, session is closed because server still holds the file.
+     * \return True if whole file is received and its CRC matches or file is not needed, false otherwise
+     */
+    virtual bool DownloadFileStream(const QJsonObject board_info, const QJsonObject client_security_data, const QString file_version, QJsonObject& server_security_data, const ChunkConsumer& consume_chunk, const FileHeaderHandler& handle_file_header = FileHeaderHandler());
+
+    /*!
+     * \brief Close authenticated session kept open between requests. Session is also closed after it is idle for a while.
+     */
+    virtual void CloseSession();
+
+    /*!
+     * \brief Set connect times measured in previous runs, faster servers are tried first
+     * \param server_rtts - Connect time in [ms] keyed by "address:port"
+     */
+    void SetServerRtts(const QHash<QString, int>& server_rtts);
+
+    /*!
+     * \brief Get connect times of the servers, failed servers have the connect timeout
+     * \return Connect time in [ms] keyed by "address:port"
+     */
+    QHash<QString, int> ServerRtts() const;
+
+    /*!
+     * \brief Set servers found in previous runs not to support framing, they are not asked for it again
+     * \param legacy_servers - Server keys "address:port"
+     */
+    void SetLegacyServers(const QSet<QString>& legacy_servers);
+
+    /*!
+     * \brief Get servers that do not support framing
+     * \return Server keys "address:port"
+     */
+    QSet<QString> LegacyServers() const;
 
   private:
+    /*!
+     * \brief Method used to run request on the authenticated session. Session is opened if needed and kept open after
+     * successful request. Request on reused session that gets no answer is repeated once on a new connection.
+     * \param request - Function that sends request and reads the answer
+     * \return True if request is successful, false otherwise
+     */
+    virtual bool RunInSession(const std::function<bool()>& request);
+
+    /*!
+     * \brief Method used to check if authenticated session can be reused
+     * \return True if session is still connected and not idle for too long, false otherwise
+     */
+    virtual bool IsSessionOpen();
+
     /*!
      * \brief Method use to perform connect action
      * \return True if connect is performed successfully, false otherwise
@@ -110,10 +191,65 @@ class SocketClient : public QTcpSocket {
     virtual bool Connect();
 
     /*!
-     * \brief Method used to perform disconnect action
-     * \return True if disconnect is performed successfuly, false otherwise
+     * \brief Method used to race TCP connects to all servers. Servers are started in RTT order, next one is started when
+     * previous ones fail or do not connect in a short time. Connect times are recorded. Best ranked server is connected
+     * by this socket and the connection stays open if it wins, other servers are measured by throwaway sockets.
+     * \return Indexes of servers worth connecting to, first server that connected comes first
+     */
+    virtual QVector<int> RaceServers();
+
+    /*!
+     * \brief Method used to start DNS lookup of all server addresses, so connecting does not wait for it later
+     */
+    void ResolveServerAddresses();
+
+    /*!
+     * \brief Method used to get address of the server, lookup is done if address is not resolved yet
+     * \param server_address - Server host name or address
+     * \return Server address, null address if lookup fails
+     */
+    QHostAddress ResolveAddress(const QString& server_address);
+
+    /*!
+     * \brief Method used to connect to the current server, authenticate and negotiate framing
+     * \return True if connection is ready for requests, false otherwise
+     */
+    virtual bool ConnectToServer();
+
+    /*!
+     * \brief Method used to ask the server for length-prefixed framing. Older servers do not know the request, they are
+     * remembered and used without framing afterwards.
+     * \return True if connection is still usable, false otherwise
+     */
+    virtual bool NegotiateFraming();
+
+    /*!
+     * \brief Method used to get key of the current server
+     * \return Server address and port
+     */
+    QString ServerKey() const;
+
+    /*!
+     * \brief Method used to write a message, with length prefix if framing is enabled
+     * \param data - Message
+     * \return True if whole message is written, false otherwise
+     */
+    virtual bool WriteMessage(const QByteArray& data);
+
+    /*!
+     * \brief Method used to read a length-prefixed message. It returns as soon as the declared number of bytes arrives.
+     * \param out_data - Message without length prefix
+     * \param max_size - Max accepted message size, larger length or data that is not a frame is rejected right away
+     * \return True if message is read, false on timeout or invalid length
      */
-    virtual bool Disconnect();
+    virtual bool ReadFrame(QByteArray& out_data, qint64 max_size);
+
+    /*!
+     * \brief Method used to wait until the given number of bytes is received, there is no waiting for a pause
+     * \param size - Number of bytes
+     * \return True if bytes are received, false on timeout
+     */
+    bool WaitForRxDataSize(int size);
 
     /*!
      * \brief Method used to perform authentication
@@ -157,6 +293,13 @@ class SocketClient : public QTcpSocket {
     virtual bool WaitForReadyRead(int timeout);
     virtual void ReadData(QByteArray& data_out);
 
+    /*!
+     * \brief Method used to receive requested file and deliver it to the consumer chunk by chunk
+     * \param consume_chunk - Function that receives file chunks
+     * \return True if file_size_ bytes are delivered, false on timeout or if consumer aborts
+     */
+    virtual bool ReceiveFile(const ChunkConsumer& consume_chunk);
+
   public slots:
     /*!
      * \brief ReadyRead slot
@@ -179,13 +322,22 @@ class SocketClient : public QTcpSocket {
     QByteArray preshared_key_;      //!< Preshared key
     QJsonArray servers_array_;      //!< Server array
 
-    QByteArray socket_rx_data_;     //!< Byte Array work as an Rx buffer
+    communication::RingBuffer socket_rx_data_;  //!< Rx buffer, file is passed on in chunks so it stays small
     int previous_rx_data_size_{0};  //!< Previous Rx data size
     int retry_number_{0};           //!< Data catch number retries
 
     qint32 file_size_{0};           //!< File size
+    crc::Crc32Context file_crc_;    //!< CRC of the downloaded file, updated as chunks arrive
+
+    bool is_framing_enabled_{false};    //!< Messages are length-prefixed on the current connection
+    QSet<QString> legacy_servers_;      //!< Servers that do not support framing
+
+    QTimer idle_timer_;                 //!< Closes authenticated session that is not used
+    bool is_response_received_{false};  //!< Server sent data since the current request started
+    QSet<QString> sessionless_servers_; //!< Servers that answer only one request per connection
 
-    bool emit_progress{false};      //!< Flag for enabling/disabling emiting download prograss
+    QHash<QString, int> server_rtts_;                   //!< Connect time in [ms] keyed by "address:port"
+    QHash<QString, QHostAddress> resolved_addresses_;   //!< Looked up server addresses keyed by host name
 
     const QByteArray kAck{"ACK"};   //!< Byte array constant that presents ACKNOWLEDGE
 };
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtEndian>
+#include "crc32.h"
+#include "socket_client.h"
+
+constexpr char kFakeServerAddress[] {"127.0.0.1"};
+constexpr char kFakeServerKey[] {"NDQ4N2Y1YjFhZTg3ZGI3MTA1MjlhYmM3"};
+
+// Server that serves requests over a real TCP connection, it runs blocking calls in its own thread and accepts new
+// connections until it is destroyed. Server without framing support answers the capability request like an older
+// server answers unknown requests, server without session support closes the connection after each request.
+class FakeServer {
+  public:
+    FakeServer(const QByteArray& file, bool is_framing_supported, bool is_session_supported = true) :
+        is_framing_supported_(is_framing_supported),
+        is_session_supported_(is_session_supported) {
+        std::promise<quint16> port_promise;
+        port_ = port_promise.get_future().share();
+        thread_ = std::thread([this, file, &port_promise]() { Serve(file, port_promise); });
+        port_.wait();
+    }
+
+    ~FakeServer() {
+        is_running_ = false;
+        thread_.join();
+    }
+
+    void CreateServersArray(QJsonArray& json_array) {
+        QJsonObject json_object_server;
+        json_object_server.insert("address", kFakeServerAddress);
+        json_object_server.insert("port", port_.get());
+        json_object_server.insert("preshared_key", kFakeServerKey);
+        json_array.append(json_object_server);
+    }
+
+    int AuthenticationCount() const {
+        return authentication_count_;
+    }
+
+    int ConnectionCount() const {
+        return connection_count_;
+    }
+
+    int FileCount() const {
+        return file_count_;
+    }
+
+  private:
+    static constexpr int kTimeout {5000};
+    static constexpr int kPollTimeout {100};
+    static constexpr int kLengthPrefixSize {4};
+    static constexpr int kWriteSize {10000};
+
+    static bool WaitForBytes(QTcpSocket& connection, qint64 size, int timeout) {
+        while (connection.bytesAvailable() < size) {
+            if (!connection.waitForReadyRead(timeout)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadMessage(QTcpSocket& connection, QByteArray& message, int timeout) {
+        if (!is_framing_enabled_) {
+            if (!WaitForBytes(connection, 1, timeout)) {
+                return false;
+            }
+            message = connection.readAll();
+            return true;
+        }
+
+        if (!WaitForBytes(connection, kLengthPrefixSize, timeout)) {
+            return false;
+        }
+        const quint32 length = qFromBigEndian<quint32>(connection.read(kLengthPrefixSize).constData());
+        if (!WaitForBytes(connection, length, kTimeout)) {
+            return false;
+        }
+        message = connection.read(length);
+        return true;
+    }
+
+    // Message is sent in several writes
+    void WriteMessage(QTcpSocket& connection, const QByteArray& data) {
+        if (is_framing_enabled_) {
+            const quint32 length_prefix = qToBigEndian(static_cast<quint32>(data.size()));
+            connection.write(reinterpret_cast<const char *>(&length_prefix), sizeof(length_prefix));
+        }
+        for (int offset = 0; offset < data.size(); offset += kWriteSize) {
+            connection.write(data.mid(offset, kWriteSize));
+            connection.waitForBytesWritten(kTimeout);
+        }
+        while ((connection.bytesToWrite() > 0) && connection.waitForBytesWritten(kTimeout)) {}
+    }
+
+    void Serve(const QByteArray& file, std::promise<quint16>& port_promise) {
+        QTcpServer server;
+        server.listen(QHostAddress(kFakeServerAddress));
+        port_promise.set_value(server.serverPort());
+
+        while (is_running_) {
+            if (server.waitForNewConnection(kPollTimeout)) {
+                std::unique_ptr<QTcpSocket> connection(server.nextPendingConnection());
+                ++connection_count_;
+                ServeConnection(*connection, file);
+            }
+        }
+    }
+
+    void ServeConnection(QTcpSocket& connection, const QByteArray& file) {
+        is_framing_enabled_ = false;
+        std::deque<QByteArray> replies;
+
+        QByteArray message;
+        WriteMessage(connection, "ABCD");                   // Authentication token
+        // Connections that only measure connect time are closed without authentication
+        if (!ReadMessage(connection, message, kTimeout)) {  // Token hash
+            return;
+        }
+        WriteMessage(connection, "ACK");
+        ++authentication_count_;
+
+        while (is_running_ && (connection.state() == QAbstractSocket::ConnectedState)) {
+            // Next request is polled, so server notices when it is destroyed
+            if (!ReadMessage(connection, message, kPollTimeout)) {
+                continue;
+            }
+
+            const QString header = QJsonDocument::fromJson(message).object().value("header").toString();
+            if (header == socket::kHeaderClientCapabilities) {
+                if (is_framing_supported_) {
+                    QJsonObject packet_object;
+                    packet_object.insert("header", socket::kHeaderServerCapabilities);
+                    packet_object.insert("framing", "length_prefixed");
+                    is_framing_enabled_ = true;
+                    WriteMessage(connection, QJsonDocument(packet_object).toJson());
+                } else {
+                    WriteMessage(connection, "NAK");
+                }
+                continue;
+
+            } else if (header == socket::kHeaderClientBoardInfo) {
+                WriteMessage(connection, "ACK");
+
+            } else if (header == socket::kHeaderClientProductInfo) {
+                QJsonObject packet_object;
+                packet_object.insert("header", socket::kHeaderServerProductInfo);
+                QJsonObject file_info;
+                file_info.insert("file_version", "v1.0.0");
+                file_info.insert("file_source", "server");
+                packet_object.insert("product_info", QJsonArray({file_info}));
+                packet_object.insert("secure_communication", false);
+                replies.emplace_back(QJsonDocument(packet_object).toJson());
+                WriteMessage(connection, "ACK");
+
+            } else if (header == socket::kHeaderClientDownloadFile) {
+                QJsonObject packet_object;
+                packet_object.insert("header", socket::kHeaderServerDownloadFile);
+                packet_object.insert("file_crc", static_cast<qint32>(crc::CalculateCrc32(reinterpret_cast<const uint8_t *>(file.constData()), file.size(), false, false)));
+                packet_object.insert("file_size", file.size());
+                packet_object.insert("server_security_data", QJsonObject());
+                replies.emplace_back(QJsonDocument(packet_object).toJson());
+                replies.emplace_back(file);
+                WriteMessage(connection, "ACK");
+
+            } else if ((header == socket::kHeaderClientRequestData) && !replies.empty()) {
+                if (replies.front().isSharedWith(file)) {
+                    ++file_count_;
+                }
+                WriteMessage(connection, replies.front());
+                replies.pop_front();
+            }
+
+            if (!is_session_supported_ && replies.empty()) {
+                connection.disconnectFromHost();
+                return;
+            }
+        }
+    }
+
+    bool is_framing_supported_;
+    bool is_session_supported_;
+    bool is_framing_enabled_ {false};
+    std::atomic<bool> is_running_ {true};
+    std::atomic<int> authentication_count_ {0};
+    std::atomic<int> connection_count_ {0};
+    std::atomic<int> file_count_ {0};
+    std::shared_future<quint16> port_;
+    std::thread thread_;
+};
+
+inline QByteArray CreateFile() {
+    QByteArray file(300000, Qt::Uninitialized);
+    for (int i = 0; i < file.size(); ++i) {
+        file[i] = static_cast<char>(i * 31);
+    }
+    return file;
+}
@@ -1,7 +1,6 @@
-QT += testlib network
-QT -= gui
+QT += testlib network serialport widgets
 
-CONFIG += qt console warn_on depend_includepath testcase
+CONFIG += qt console warn_on depend_includepath testcase c++14
 CONFIG -= app_bundle
 
 TEMPLATE = app
@@ -13,11 +12,57 @@ DEFINES += GIT_BRANCH=\\\"release\\\"
 INCLUDEPATH += ../
 
 SOURCES +=  tst_socket.cpp \
+    tst_crc32.cpp \
+    tst_frame.cpp \
+    tst_hotplug_watcher.cpp \
+    tst_async_flash_session.cpp \
+    tst_native_serial_port.cpp \
+    tst_ring_buffer.cpp \
+    tst_firmware_cache.cpp \
+    tst_image_stream.cpp \
+    tst_file_downloader.cpp \
+    tst_flasher.cpp \
     main.cpp \
+    ../async_flash_session.cpp \
+    ../crc32.cpp \
+    ../file_downloader.cpp \
+    ../firmware_cache.cpp \
+    ../flasher.cpp \
+    ../frame.cpp \
+    ../hotplug_watcher.cpp \
+    ../image_stream.cpp \
+    ../native_serial_port.cpp \
+    ../ring_buffer.cpp \
+    ../serial_port.cpp \
     ../socket_client.cpp
 
 HEADERS += \
     tst_socket.h \
+    tst_crc32.h \
+    tst_frame.h \
+    tst_hotplug_watcher.h \
+    tst_async_flash_session.h \
+    tst_native_serial_port.h \
+    tst_ring_buffer.h \
+    tst_firmware_cache.h \
+    tst_image_stream.h \
+    tst_file_downloader.h \
+    tst_flasher.h \
+    fake_server.h \
+    ../async_flash_session.h \
+    ../crc32.h \
+    ../file_downloader.h \
+    ../firmware_cache.h \
+    ../flasher.h \
+    ../flasher_protocol.h \
+    ../flasher_states.h \
+    ../flashing_info.h \
+    ../frame.h \
+    ../hotplug_watcher.h \
+    ../image_stream.h \
+    ../native_serial_port.h \
+    ../ring_buffer.h \
+    ../serial_port.h \
     ../socket_client.h
 
 RESOURCES += \
@@ -1,11 +1,32 @@
 #include <QtTest/QtTest>
 #include "tst_socket.h"
+#include "tst_crc32.h"
+#include "tst_frame.h"
+#include "tst_hotplug_watcher.h"
+#include "tst_async_flash_session.h"
+#include "tst_native_serial_port.h"
+#include "tst_ring_buffer.h"
+#include "tst_firmware_cache.h"
+#include "tst_image_stream.h"
+#include "tst_file_downloader.h"
+#include "tst_flasher.h"
 #include <QObject>
 
 int main(int argc, char *argv[]) {
+    // Event loop is needed by the tests of asynchronous code
+    QCoreApplication app(argc, argv);
     int status = 0;
     status |= QTest::qExec(new TestSocket, argc, argv);
-    //status |= QTest::qExec(new TestFlasher, argc, argv);
+    status |= QTest::qExec(new TestCrc32, argc, argv);
+    status |= QTest::qExec(new TestFrame, argc, argv);
+    status |= QTest::qExec(new TestHotplugWatcher, argc, argv);
+    status |= QTest::qExec(new TestAsyncFlashSession, argc, argv);
+    status |= QTest::qExec(new TestNativeSerialPort, argc, argv);
+    status |= QTest::qExec(new TestRingBuffer, argc, argv);
+    status |= QTest::qExec(new TestFirmwareCache, argc, argv);
+    status |= QTest::qExec(new TestImageStream, argc, argv);
+    status |= QTest::qExec(new TestFileDownloader, argc, argv);
+    status |= QTest::qExec(new TestFlasher, argc, argv);
 
     return status;
 }
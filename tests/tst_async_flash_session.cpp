@@ -0,0 +1,227 @@
+#include "tst_async_flash_session.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <QtEndian>
+
+namespace {
+
+constexpr int kImageSize {64 * 1024};
+constexpr int kSignatureSize {64};
+constexpr int kBenchmarkTimeoutInMs {30000};
+constexpr int kNumOfCapabilitiesParts {4};
+
+// Bootloader that acknowledges every request on the next event loop pass
+class FakeBootloader : public QIODevice {
+
+  public:
+    explicit FakeBootloader(bool is_responding = true) :
+        is_responding_(is_responding) {
+        open(QIODevice::ReadWrite);
+    }
+
+    QByteArray last_request_;             //!< Last received request
+    qint64 received_size_ {0};            //!< Total number of received bytes
+    qint64 max_request_size_ {0};         //!< Size of the largest request
+    QByteArray capabilities_;             //!< Capabilities JSON, capability request is acknowledged like others if empty
+    bool is_capabilities_late_ {false};   //!< Capabilities are sent in front of the response to the next request
+    int capabilities_part_period_ms_ {0}; //!< Capabilities are sent in parts with this period if not 0
+
+  protected:
+    qint64 readData(char *data, qint64 max_size) override {
+        const qint64 size = qMin(max_size, static_cast<qint64>(response_.size()));
+        memcpy(data, response_.constData(), size);
+        response_.remove(0, size);
+        return size;
+    }
+
+    qint64 writeData(const char *data, qint64 size) override {
+        last_request_ = QByteArray(data, size);
+        received_size_ += size;
+        max_request_size_ = qMax(max_request_size_, size);
+
+        if (is_responding_) {
+            if (!capabilities_.isEmpty() && (last_request_ == QByteArray(flasher::kCapabilitiesJsonCmd, sizeof(flasher::kCapabilitiesJsonCmd)))) {
+                uchar crc[4];
+                qToBigEndian<quint32>(crc::CalculateCrc32(reinterpret_cast<const uint8_t *>(capabilities_.constData()), capabilities_.size(), false, false), crc);
+                const QByteArray capabilities = capabilities_ + QByteArray(reinterpret_cast<const char *>(crc), sizeof(crc));
+
+                // Next request is sent only after the session stopped waiting for capabilities
+                if (is_capabilities_late_) {
+                    late_response_ = capabilities;
+                    return size;
+                }
+
+                if (capabilities_part_period_ms_ > 0) {
+                    const int part_size = (capabilities.size() + kNumOfCapabilitiesParts - 1) / kNumOfCapabilitiesParts;
+                    for (int i = 0; i < kNumOfCapabilitiesParts; ++i) {
+                        QTimer::singleShot((i + 1) * capabilities_part_period_ms_, this, [this, part = capabilities.mid(i * part_size, part_size)]() {
+                            response_.append(part);
+                            emit readyRead();
+                        });
+                    }
+                    return size;
+                }
+
+                response_.append(capabilities);
+            } else {
+                response_.append(late_response_);
+                late_response_.clear();
+                response_.append("OK");
+            }
+            QTimer::singleShot(0, this, [this]() { emit readyRead(); });
+        }
+
+        return size;
+    }
+
+    qint64 bytesAvailable() const override {
+        return response_.size() + QIODevice::bytesAvailable();
+    }
+
+  private:
+    bool is_responding_;
+    QByteArray response_;
+    QByteArray late_response_;
+};
+
+QByteArray CreateImage() {
+    QByteArray image(kImageSize, Qt::Uninitialized);
+    for (int i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<char>(i * 7);
+    }
+    return image;
+}
+
+} // namespace
+
+TestAsyncFlashSession::TestAsyncFlashSession() = default;
+TestAsyncFlashSession::~TestAsyncFlashSession() = default;
+
+void TestAsyncFlashSession::TestFlash() {
+    const QByteArray image = CreateImage();
+    FakeBootloader bootloader;
+    flasher::AsyncFlashSession session(bootloader, image);
+    QSignalSpy finished_spy(&session, &flasher::AsyncFlashSession::Finished);
+
+    session.Start();
+
+    QVERIFY(finished_spy.wait(5000));
+    QVERIFY(session.GetFlashingInfo().success);
+
+    // Fake bootloader accepts the signature, CRC covers the rest of the image
+    const uint32_t crc = crc::CalculateCrc32(reinterpret_cast<const uint8_t *>(image.constData()) + kSignatureSize, kImageSize - kSignatureSize, false, false);
+    QCOMPARE(bootloader.last_request_, QByteArray::number(crc));
+}
+
+void TestAsyncFlashSession::TestNoResponse() {
+    FakeBootloader bootloader(false);
+    flasher::AsyncFlashSession session(bootloader, CreateImage());
+    QSignalSpy finished_spy(&session, &flasher::AsyncFlashSession::Finished);
+
+    session.Start();
+
+    QVERIFY(finished_spy.wait(5000));
+    QVERIFY(!session.GetFlashingInfo().success);
+    QCOMPARE(session.GetFlashingInfo().description, QString("Check signature problem"));
+}
+
+void TestAsyncFlashSession::TestPacketSizeNegotiation() {
+    const QByteArray image = CreateImage();
+    FakeBootloader bootloader;
+    bootloader.capabilities_ = R"({"max_packet_size": 1000})";
+    flasher::AsyncFlashSession session(bootloader, image);
+    QSignalSpy finished_spy(&session, &flasher::AsyncFlashSession::Finished);
+
+    session.Start();
+
+    // Max packet size is aligned down to the default packet size
+    QVERIFY(finished_spy.wait(5000));
+    QVERIFY(session.GetFlashingInfo().success);
+    QCOMPARE(bootloader.max_request_size_, static_cast<qint64>(768));
+}
+
+void TestAsyncFlashSession::TestLateCapabilities() {
+    FakeBootloader bootloader;
+    bootloader.capabilities_ = R"({"max_packet_size": 1000})";
+    bootloader.is_capabilities_late_ = true;
+    flasher::AsyncFlashSession session(bootloader, CreateImage());
+    QSignalSpy finished_spy(&session, &flasher::AsyncFlashSession::Finished);
+
+    session.Start();
+
+    // Late capabilities arrive together with the signature check ACK, they are dropped and default packet size is used
+    QVERIFY(finished_spy.wait(5000));
+    QVERIFY(session.GetFlashingInfo().success);
+    QCOMPARE(bootloader.max_request_size_, static_cast<qint64>(flasher::kPacketSize));
+}
+
+void TestAsyncFlashSession::TestSlowCapabilities() {
+    FakeBootloader bootloader;
+    bootloader.capabilities_ = R"({"max_packet_size": 1000})";
+    bootloader.capabilities_part_period_ms_ = flasher::kCapabilitiesTimeoutInMs / 2;
+    flasher::AsyncFlashSession session(bootloader, CreateImage());
+    QSignalSpy finished_spy(&session, &flasher::AsyncFlashSession::Finished);
+
+    session.Start();
+
+    // Whole reply takes longer than the capabilities timeout, but it keeps arriving
+    QVERIFY(finished_spy.wait(5000));
+    QVERIFY(session.GetFlashingInfo().success);
+    QCOMPARE(bootloader.max_request_size_, static_cast<qint64>(768));
+}
+
+void TestAsyncFlashSession::TestEmptyImage() {
+    FakeBootloader bootloader;
+    flasher::AsyncFlashSession session(bootloader, CreateImage().left(kSignatureSize));
+    QSignalSpy finished_spy(&session, &flasher::AsyncFlashSession::Finished);
+
+    session.Start();
+
+    // Image with signature only goes from erase straight to the CRC check
+    QVERIFY(finished_spy.wait(5000));
+    QVERIFY(session.GetFlashingInfo().success);
+    QCOMPARE(bootloader.last_request_, QByteArray::number(crc::CalculateCrc32(nullptr, 0, false, false)));
+}
+
+void TestAsyncFlashSession::BenchmarkCpuPerPort_data() {
+    QTest::addColumn<int>("num_of_ports");
+    QTest::newRow("1 port") << 1;
+    QTest::newRow("8 ports") << 8;
+    QTest::newRow("32 ports") << 32;
+    QTest::newRow("64 ports") << 64;
+}
+
+void TestAsyncFlashSession::BenchmarkCpuPerPort() {
+    QFETCH(int, num_of_ports);
+    const QByteArray image = CreateImage();
+
+    // CPU time is reported with -tickcounter or -callgrind, wall time by default
+    QBENCHMARK {
+        std::vector<std::unique_ptr<FakeBootloader>> bootloaders;
+        std::vector<std::unique_ptr<flasher::AsyncFlashSession>> sessions;
+        QEventLoop event_loop;
+        int running_sessions = num_of_ports;
+        int success_count = 0;
+
+        for (int i = 0; i < num_of_ports; ++i) {
+            bootloaders.push_back(std::make_unique<FakeBootloader>());
+            sessions.push_back(std::make_unique<flasher::AsyncFlashSession>(*bootloaders.back(), image));
+            flasher::AsyncFlashSession *session = sessions.back().get();
+            connect(session, &flasher::AsyncFlashSession::Finished, &event_loop, [&](bool success) {
+                success_count += success ? 1 : 0;
+                if (--running_sessions == 0) {
+                    event_loop.quit();
+                }
+            });
+            session->Start();
+        }
+
+        // Session that never finishes fails the benchmark instead of blocking the test run
+        QTimer::singleShot(kBenchmarkTimeoutInMs, &event_loop, &QEventLoop::quit);
+        event_loop.exec();
+
+        QCOMPARE(success_count, num_of_ports);
+    }
+}
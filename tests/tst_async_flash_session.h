@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QtTest>
+#include "async_flash_session.h"
+
+class TestAsyncFlashSession : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestAsyncFlashSession();
+    ~TestAsyncFlashSession();
+
+  private slots:
+    void TestFlash();
+    void TestNoResponse();
+    void TestPacketSizeNegotiation();
+    void TestLateCapabilities();
+    void TestSlowCapabilities();
+    void TestEmptyImage();
+    void BenchmarkCpuPerPort_data();
+    void BenchmarkCpuPerPort();
+};
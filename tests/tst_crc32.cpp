@@ -0,0 +1,166 @@
+#include "tst_crc32.h"
+
+#include <vector>
+
+namespace {
+
+constexpr char kCheckData[] {"123456789"};
+constexpr uint32_t kCheckDataSize {9U};
+constexpr uint32_t kMaxLength {1100U};
+constexpr uint32_t kMaxOffset {16U};
+constexpr uint32_t kClmulBufferSize {1U << 20U};
+constexpr int kClmulIterations {2000};
+constexpr uint32_t kParallelBufferSize {(16U << 20U) + 13U};
+
+uint32_t NextRandom(uint32_t& seed) {
+    seed = (seed * 1103515245U) + 12345U;
+    return seed >> 8U;
+}
+
+uint32_t ReflectBits(uint32_t data, const uint8_t num_of_bits) {
+    uint32_t reflection = 0U;
+
+    for (uint8_t bit = 0U; bit < num_of_bits; ++bit) {
+        if (data & 0x01U) {
+            reflection |= (1U << ((num_of_bits - 1U) - bit));
+        }
+        data = (data >> 1U);
+    }
+
+    return reflection;
+}
+
+// Bit-at-a-time reference of the original byte-wise implementation
+uint32_t ReferenceCrc32(const uint8_t *data, uint32_t length, bool reflected_output, bool reflected_input) {
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (uint32_t i = 0U; i < length; ++i) {
+        const uint8_t byte = reflected_input ? ReflectBits(data[i], 8U) : data[i];
+        crc ^= static_cast<uint32_t>(byte) << 24U;
+
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000U) ? ((crc << 1U) ^ 0x04C11DB7U) : (crc << 1U);
+        }
+    }
+
+    crc ^= 0xFFFFFFFFU;
+
+    return reflected_output ? ReflectBits(crc, 32U) : crc;
+}
+
+} // namespace
+
+TestCrc32::TestCrc32() = default;
+TestCrc32::~TestCrc32() = default;
+
+void TestCrc32::TestCheckValues() {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(kCheckData);
+
+    QCOMPARE(crc::CalculateCrc32(data, kCheckDataSize, false, false), 0xFC891918U);
+    QCOMPARE(crc::CalculateCrc32(data, kCheckDataSize, true, true), 0xCBF43926U);
+    QCOMPARE(crc::CalculateCrc32(data, 0U, false, false), 0x00000000U);
+}
+
+void TestCrc32::TestMatchesBitwiseReference() {
+    std::vector<uint8_t> buffer(kMaxLength + kMaxOffset);
+    uint32_t seed = 0x12345678U;
+    for (auto& byte : buffer) {
+        byte = static_cast<uint8_t>(NextRandom(seed));
+    }
+
+    for (uint32_t length = 0U; length < kMaxLength; length += 7U) {
+        for (uint32_t offset = 0U; offset < kMaxOffset; ++offset) {
+            const uint8_t *data = buffer.data() + offset;
+
+            for (int variant = 0; variant < 4; ++variant) {
+                const bool reflected_output = (variant & 0x01);
+                const bool reflected_input = (variant & 0x02);
+
+                QCOMPARE(crc::CalculateCrc32(data, length, reflected_output, reflected_input),
+                         ReferenceCrc32(data, length, reflected_output, reflected_input));
+            }
+        }
+    }
+}
+
+void TestCrc32::TestClmulMatchesReference() {
+    if (!crc::IsClmulSupported()) {
+        QSKIP("PCLMULQDQ/SSE4.1 not supported on this CPU");
+    }
+
+    std::vector<uint8_t> buffer(kClmulBufferSize);
+    uint32_t seed = 0xCAFEBABEU;
+    for (auto& byte : buffer) {
+        byte = static_cast<uint8_t>(NextRandom(seed));
+    }
+
+    for (int i = 0; i < kClmulIterations; ++i) {
+        const uint32_t offset = NextRandom(seed) % kMaxOffset;
+        // Mostly short lengths around the 16/64 byte block boundaries, sometimes long ones
+        const uint32_t max_length = (i % 10 == 0) ? (kClmulBufferSize - kMaxOffset) : 1024U;
+        const uint32_t length = NextRandom(seed) % max_length;
+        const uint8_t *data = buffer.data() + offset;
+
+        // CalculateCrc32() uses the same kernel for longer data, so the kernel is checked against the bitwise reference
+        QCOMPARE(crc::CalculateCrc32Clmul(data, length, false), ReferenceCrc32(data, length, false, false));
+        QCOMPARE(crc::CalculateCrc32Clmul(data, length, true), ReferenceCrc32(data, length, true, false));
+    }
+}
+
+void TestCrc32::TestIncrementalMatchesSinglePass() {
+    std::vector<uint8_t> buffer(kMaxLength * 8U);
+    uint32_t seed = 0x0BADF00DU;
+    for (auto& byte : buffer) {
+        byte = static_cast<uint8_t>(NextRandom(seed));
+    }
+
+    for (int variant = 0; variant < 4; ++variant) {
+        const bool reflected_output = (variant & 0x01);
+        const bool reflected_input = (variant & 0x02);
+
+        crc::Crc32Context context;
+        crc::InitCrc32(context, reflected_output, reflected_input);
+
+        uint32_t position = 0U;
+        while (position < buffer.size()) {
+            // Chunks from 1 byte up to a few hundred, so both table and folding kernels are used
+            const uint32_t chunk = qMin<uint32_t>((NextRandom(seed) % 300U) + 1U, buffer.size() - position);
+            crc::UpdateCrc32(context, buffer.data() + position, chunk);
+            position += chunk;
+
+            QCOMPARE(crc::FinalizeCrc32(context), crc::CalculateCrc32(buffer.data(), position, reflected_output, reflected_input));
+        }
+
+        QCOMPARE(context.length, static_cast<uint64_t>(buffer.size()));
+    }
+}
+
+void TestCrc32::TestCombine() {
+    std::vector<uint8_t> buffer(kMaxLength);
+    uint32_t seed = 0xFEEDFACEU;
+    for (auto& byte : buffer) {
+        byte = static_cast<uint8_t>(NextRandom(seed));
+    }
+
+    for (uint32_t length1 = 0U; length1 < kMaxLength; length1 += 37U) {
+        for (uint32_t length2 = 0U; (length1 + length2) < kMaxLength; length2 += 41U) {
+            const uint32_t crc1 = crc::CalculateCrc32(buffer.data(), length1, false, false);
+            const uint32_t crc2 = crc::CalculateCrc32(buffer.data() + length1, length2, false, false);
+
+            QCOMPARE(crc::CombineCrc32(crc1, crc2, length2), crc::CalculateCrc32(buffer.data(), length1 + length2, false, false));
+        }
+    }
+}
+
+void TestCrc32::TestParallelMatchesSinglePass() {
+    std::vector<uint8_t> buffer(kParallelBufferSize);
+    uint32_t seed = 0xDEADBEEFU;
+    for (auto& byte : buffer) {
+        byte = static_cast<uint8_t>(NextRandom(seed));
+    }
+
+    for (const uint32_t length : {0U, 1000U, kParallelBufferSize / 3U, kParallelBufferSize}) {
+        QCOMPARE(crc::CalculateCrc32Parallel(buffer.data(), length, false), crc::CalculateCrc32(buffer.data(), length, false, false));
+        QCOMPARE(crc::CalculateCrc32Parallel(buffer.data(), length, true), crc::CalculateCrc32(buffer.data(), length, true, false));
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QtTest>
+#include "crc32.h"
+
+class TestCrc32 : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestCrc32();
+    ~TestCrc32();
+
+  private slots:
+    void TestCheckValues();
+    void TestMatchesBitwiseReference();
+    void TestClmulMatchesReference();
+    void TestIncrementalMatchesSinglePass();
+    void TestCombine();
+    void TestParallelMatchesSinglePass();
+};
@@ -0,0 +1,84 @@
+#include "tst_file_downloader.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+
+constexpr char kFile[] = "firmware image";
+constexpr char kPage[] = "<html>moved</html>";
+
+// HTTP server on the test thread, replies are served while download runs its event loop
+class FakeHttpServer : public QObject {
+
+  public:
+    FakeHttpServer() {
+        server_.listen(QHostAddress::LocalHost);
+        connect(&server_, &QTcpServer::newConnection, this, [this]() {
+            QTcpSocket *connection = server_.nextPendingConnection();
+            connect(connection, &QTcpSocket::readyRead, connection, [connection]() {
+                // Whole request line arrives at once on the loopback
+                const QByteArray path = connection->readAll().split(' ').value(1);
+                connection->write(Reply(path));
+                connection->disconnectFromHost();
+            });
+            connect(connection, &QTcpSocket::disconnected, connection, &QObject::deleteLater);
+        });
+    }
+
+    QUrl Url(const QString& path) const {
+        return QUrl(QString("http://127.0.0.1:%1%2").arg(server_.serverPort()).arg(path));
+    }
+
+  private:
+    // File is sent without its size, so it is held back until the reply is finished
+    static QByteArray Reply(const QByteArray& path) {
+        if (path == "/redirect") {
+            return QByteArray("HTTP/1.1 302 Found\r\nLocation: /file\r\nContent-Length: ") + QByteArray::number(qstrlen(kPage)) +
+                   "\r\nConnection: close\r\n\r\n" + kPage;
+        } else if (path == "/multiple_choices") {
+            return QByteArray("HTTP/1.1 300 Multiple Choices\r\nConnection: close\r\n\r\n") + kPage;
+        }
+        return QByteArray("HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n") + kFile;
+    }
+
+    QTcpServer server_;
+};
+
+} // namespace
+
+TestFileDownloader::TestFileDownloader() = default;
+TestFileDownloader::~TestFileDownloader() = default;
+
+void TestFileDownloader::TestRedirect() {
+    FakeHttpServer server;
+    file_downloader::FileDownloader file_downloader;
+    qint64 file_size = -1;
+    QByteArray file;
+
+    QVERIFY(file_downloader.DownloadStream(server.Url("/redirect"), [&file_size](qint64 size) {
+        file_size = size;
+    }, [&file](const char *chunk, int size) {
+        file.append(chunk, size);
+        return true;
+    }));
+
+    QCOMPARE(file, QByteArray(kFile));
+    QCOMPARE(file_size, static_cast<qint64>(file.size()));
+}
+
+void TestFileDownloader::TestUnfollowedRedirect() {
+    FakeHttpServer server;
+    file_downloader::FileDownloader file_downloader;
+    bool is_file_delivered = false;
+
+    // Redirect without location is a successful reply for Qt, its page must not be taken for the file
+    QVERIFY(!file_downloader.DownloadStream(server.Url("/multiple_choices"), [&is_file_delivered](qint64) {
+        is_file_delivered = true;
+    }, [&is_file_delivered](const char *, int) {
+        is_file_delivered = true;
+        return true;
+    }));
+
+    QVERIFY(!is_file_delivered);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QtTest>
+#include "file_downloader.h"
+
+class TestFileDownloader : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestFileDownloader();
+    ~TestFileDownloader();
+
+  private slots:
+    void TestRedirect();
+    void TestUnfollowedRedirect();
+};
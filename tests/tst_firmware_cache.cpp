@@ -0,0 +1,68 @@
+#include "tst_firmware_cache.h"
+
+#include <QTemporaryDir>
+
+TestFirmwareCache::TestFirmwareCache() = default;
+TestFirmwareCache::~TestFirmwareCache() = default;
+
+void TestFirmwareCache::TestStoreAndLoad() {
+    QTemporaryDir directory;
+    firmware_cache::FirmwareCache cache(directory.path() + "/cache", 1000);
+    const QString key = firmware_cache::FirmwareCache::MakeKey("product", "v1.0.0", "server", "12345678");
+    const QByteArray file(100, 'a');
+
+    QByteArray content;
+    QVERIFY(!cache.Load(key, content));
+    QVERIFY(cache.Store(key, file));
+    QVERIFY(cache.Load(key, content));
+    QCOMPARE(content, file);
+
+    // Same content under another key is stored once
+    QVERIFY(cache.Store(firmware_cache::FirmwareCache::MakeKey("product", "v1.0.1", "server", "12345678"), file));
+    QCOMPARE(QDir(directory.path() + "/cache").entryList({"*.bin"}).size(), 1);
+
+    // Cache is kept on disk
+    firmware_cache::FirmwareCache reopened_cache(directory.path() + "/cache", 1000);
+    QVERIFY(reopened_cache.Load(key, content));
+    QCOMPARE(content, file);
+
+    QVERIFY(!cache.Store("too_large", QByteArray(1001, 'b')));
+}
+
+void TestFirmwareCache::TestEviction() {
+    QTemporaryDir directory;
+    firmware_cache::FirmwareCache cache(directory.path(), 250);
+    QByteArray content;
+
+    QVERIFY(cache.Store("a", QByteArray(100, 'a')));
+    QVERIFY(cache.Store("b", QByteArray(100, 'b')));
+    QVERIFY(cache.Load("a", content));
+
+    // "b" is least recently used, it makes room for "c"
+    QVERIFY(cache.Store("c", QByteArray(100, 'c')));
+    QVERIFY(cache.Load("a", content));
+    QVERIFY(!cache.Load("b", content));
+    QVERIFY(cache.Load("c", content));
+    QCOMPARE(content, QByteArray(100, 'c'));
+}
+
+void TestFirmwareCache::TestDamagedFile() {
+    QTemporaryDir directory;
+    firmware_cache::FirmwareCache cache(directory.path(), 1000);
+    QVERIFY(cache.Store("a", QByteArray(100, 'a')));
+
+    const QStringList files = QDir(directory.path()).entryList({"*.bin"});
+    QCOMPARE(files.size(), 1);
+    QFile file(QDir(directory.path()).filePath(files.first()));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.seek(50);
+    file.write("x");
+    file.close();
+
+    // Damaged file is not returned and it is removed
+    QByteArray content;
+    QVERIFY(!cache.Load("a", content));
+    QVERIFY(content.isEmpty());
+    QVERIFY(!file.exists());
+    QVERIFY(!cache.Load("a", content));
+}
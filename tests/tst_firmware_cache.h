@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QtTest>
+#include "firmware_cache.h"
+
+class TestFirmwareCache : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestFirmwareCache();
+    ~TestFirmwareCache();
+
+  private slots:
+    void TestStoreAndLoad();
+    void TestEviction();
+    void TestDamagedFile();
+};
@@ -0,0 +1,51 @@
+#include "tst_flasher.h"
+
+#include <memory>
+#include <QTemporaryDir>
+#include "fake_server.h"
+#include "firmware_cache.h"
+
+namespace {
+
+constexpr int kDownloadTimeoutInMs {5000};
+
+} // namespace
+
+TestFlasher::TestFlasher() = default;
+TestFlasher::~TestFlasher() = default;
+
+void TestFlasher::TestCachedServerDownload() {
+    QTemporaryDir directory;
+    const QByteArray file = CreateFile();
+    FakeServer server(file, true);
+    QJsonArray servers_array;
+    server.CreateServersArray(servers_array);
+
+    QJsonObject board_info;
+    board_info.insert("product_type", "test_product_type");
+
+    flasher::Flasher flasher;
+    flasher.SetDownloadSources(std::make_shared<socket::SocketClient>(std::move(servers_array)),
+                               std::make_unique<firmware_cache::FirmwareCache>(directory.path() + "/cache", 10 * file.size()));
+    flasher.SetBoardInfo(board_info);
+
+    // Product information of the board lists the file version on the server
+    flasher.SetState(flasher::FlasherStates::kServerDataExchange);
+    flasher.LoopHandler();
+    flasher.SetSelectedFileVersion("v1.0.0");
+
+    // First load downloads the file, it is cached once the board confirms its CRC
+    flasher.SetState(flasher::FlasherStates::kLoadFile);
+    flasher.LoopHandler();
+    QVERIFY(flasher.WaitForImageData(file.size(), kDownloadTimeoutInMs));
+    QCOMPARE(flasher.GetFileContent(), file);
+    flasher.StoreFileInCache();
+    QCOMPARE(server.FileCount(), 1);
+
+    // Second load of the same version is served from the cache, server only announces the file
+    flasher.SetState(flasher::FlasherStates::kLoadFile);
+    flasher.LoopHandler();
+    QVERIFY(flasher.WaitForImageData(file.size(), kDownloadTimeoutInMs));
+    QCOMPARE(flasher.GetFileContent(), file);
+    QCOMPARE(server.FileCount(), 1);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QtTest>
+#include "flasher.h"
+
+class TestFlasher : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestFlasher();
+    ~TestFlasher();
+
+  private slots:
+    void TestCachedServerDownload();
+};
@@ -0,0 +1,56 @@
+#include "tst_frame.h"
+
+namespace {
+
+constexpr char kPayload[] = "capabilities_json";
+
+} // namespace
+
+TestFrame::TestFrame() = default;
+TestFrame::~TestFrame() = default;
+
+void TestFrame::TestEncodeDecode() {
+    const QByteArray encoded = communication::EncodeFrame(communication::FrameType::kRequest, 0x1234U, kPayload, sizeof(kPayload));
+    QCOMPARE(encoded.size(), communication::kFrameHeaderSize + static_cast<int>(sizeof(kPayload)) + communication::kFrameCrcSize);
+
+    // Trailing data of the next frame must not be consumed
+    const QByteArray data = encoded + communication::EncodeFrame(communication::FrameType::kAck, 0U, nullptr, 0);
+
+    communication::Frame frame;
+    int frame_size = 0;
+    QCOMPARE(communication::DecodeFrame(data, frame, frame_size), communication::FrameStatus::kComplete);
+    QCOMPARE(frame_size, encoded.size());
+    QCOMPARE(frame.type, communication::FrameType::kRequest);
+    QCOMPARE(frame.sequence_number, static_cast<uint16_t>(0x1234U));
+    QCOMPARE(frame.payload, QByteArray(kPayload, sizeof(kPayload)));
+}
+
+void TestFrame::TestIncomplete() {
+    const QByteArray encoded = communication::EncodeFrame(communication::FrameType::kResponse, 1U, kPayload, sizeof(kPayload));
+    int frame_size = 0;
+
+    for (int size = 0; size < encoded.size(); ++size) {
+        QCOMPARE(communication::PeekFrame(encoded.left(size), frame_size), communication::FrameStatus::kIncomplete);
+    }
+
+    QCOMPARE(communication::PeekFrame(encoded, frame_size), communication::FrameStatus::kComplete);
+}
+
+void TestFrame::TestInvalid() {
+    QByteArray encoded = communication::EncodeFrame(communication::FrameType::kResponse, 1U, kPayload, sizeof(kPayload));
+    int frame_size = 0;
+
+    // Text response from a bootloader that does not use framing
+    QCOMPARE(communication::PeekFrame(QByteArray("OK"), frame_size), communication::FrameStatus::kInvalid);
+
+    encoded[communication::kFrameHeaderSize] = static_cast<char>(encoded.at(communication::kFrameHeaderSize) ^ 0x01);
+    QCOMPARE(communication::PeekFrame(encoded, frame_size), communication::FrameStatus::kInvalid);
+}
+
+void TestFrame::TestPayloadTooLong() {
+    const QByteArray payload(communication::kMaxFramePayloadSize + 1, 'a');
+
+    // Length field has 16 bits, payload that does not fit is not encoded
+    QVERIFY(communication::EncodeFrame(communication::FrameType::kRequest, 0U, payload.constData(), payload.size()).isEmpty());
+    QVERIFY(!communication::EncodeFrame(communication::FrameType::kRequest, 0U, payload.constData(), payload.size() - 1).isEmpty());
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QtTest>
+#include "frame.h"
+
+class TestFrame : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestFrame();
+    ~TestFrame();
+
+  private slots:
+    void TestEncodeDecode();
+    void TestIncomplete();
+    void TestInvalid();
+    void TestPayloadTooLong();
+};
@@ -0,0 +1,56 @@
+#include "tst_hotplug_watcher.h"
+
+namespace {
+
+QByteArray Uevent(const char *action, const char *dev_path, const char *subsystem, const char *dev_name) {
+    QByteArray uevent;
+    uevent.append(action).append('@').append(dev_path).append('\0');
+    uevent.append("ACTION=").append(action).append('\0');
+    uevent.append("DEVPATH=").append(dev_path).append('\0');
+    uevent.append("SUBSYSTEM=").append(subsystem).append('\0');
+    uevent.append("DEVNAME=").append(dev_name).append('\0');
+    uevent.append("SEQNUM=4242").append('\0');
+    return uevent;
+}
+
+constexpr char kAcmDevPath[] = "/devices/pci0000:00/0000:00:14.0/usb1/1-2/1-2:1.0/tty/ttyACM0";
+
+} // namespace
+
+TestHotplugWatcher::TestHotplugWatcher() = default;
+TestHotplugWatcher::~TestHotplugWatcher() = default;
+
+void TestHotplugWatcher::TestTtyAdded() {
+    communication::HotplugWatcher hotplug_watcher;
+    QSignalSpy added_spy(&hotplug_watcher, &communication::HotplugWatcher::PortAdded);
+    QSignalSpy removed_spy(&hotplug_watcher, &communication::HotplugWatcher::PortRemoved);
+
+    hotplug_watcher.InjectUevent(Uevent("add", kAcmDevPath, "tty", "ttyACM0"));
+
+    QCOMPARE(added_spy.count(), 1);
+    QCOMPARE(added_spy.at(0).at(0).toString(), QString("ttyACM0"));
+    QCOMPARE(removed_spy.count(), 0);
+}
+
+void TestHotplugWatcher::TestTtyRemoved() {
+    communication::HotplugWatcher hotplug_watcher;
+    QSignalSpy added_spy(&hotplug_watcher, &communication::HotplugWatcher::PortAdded);
+    QSignalSpy removed_spy(&hotplug_watcher, &communication::HotplugWatcher::PortRemoved);
+
+    hotplug_watcher.InjectUevent(Uevent("remove", kAcmDevPath, "tty", "ttyACM0"));
+
+    QCOMPARE(added_spy.count(), 0);
+    QCOMPARE(removed_spy.count(), 1);
+    QCOMPARE(removed_spy.at(0).at(0).toString(), QString("ttyACM0"));
+}
+
+void TestHotplugWatcher::TestIgnoredDevices() {
+    communication::HotplugWatcher hotplug_watcher;
+    QSignalSpy added_spy(&hotplug_watcher, &communication::HotplugWatcher::PortAdded);
+
+    hotplug_watcher.InjectUevent(Uevent("add", "/devices/pci0000:00/0000:00:14.0/usb1/1-2/1-2:1.0", "usb", "bus/usb/001/005"));
+    hotplug_watcher.InjectUevent(Uevent("add", "/devices/virtual/tty/tty5", "tty", "tty5"));
+    hotplug_watcher.InjectUevent(Uevent("bind", kAcmDevPath, "tty", "ttyACM0"));
+
+    QCOMPARE(added_spy.count(), 0);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QtTest>
+#include "hotplug_watcher.h"
+
+class TestHotplugWatcher : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestHotplugWatcher();
+    ~TestHotplugWatcher();
+
+  private slots:
+    void TestTtyAdded();
+    void TestTtyRemoved();
+    void TestIgnoredDevices();
+};
@@ -0,0 +1,80 @@
+#include "tst_image_stream.h"
+
+#include <thread>
+
+TestImageStream::TestImageStream() = default;
+TestImageStream::~TestImageStream() = default;
+
+void TestImageStream::TestStreamedData() {
+    flasher::ImageStream image_stream;
+    QByteArray file(10000, Qt::Uninitialized);
+    for (int i = 0; i < file.size(); ++i) {
+        file[i] = static_cast<char>(i * 7);
+    }
+
+    // Producer sends the file in chunks with pauses, consumer reads each part as soon as it arrives
+    std::thread producer([&image_stream, &file]() {
+        QThread::msleep(20);
+        image_stream.SetSize(file.size());
+        for (int offset = 0; offset < file.size(); offset += 1000) {
+            QThread::msleep(5);
+            image_stream.Append(file.constData() + offset, 1000);
+        }
+        image_stream.Finish(true);
+    });
+
+    QVERIFY(!image_stream.WaitForData(1, 0));
+    QVERIFY(image_stream.WaitForSize(1000));
+    const QByteArray content = image_stream.Content();
+    QCOMPARE(content.size(), file.size());
+
+    for (int offset = 0; offset < file.size(); offset += 500) {
+        QVERIFY(image_stream.WaitForData(offset + 500, 1000));
+        QCOMPARE(content.mid(offset, 500), file.mid(offset, 500));
+    }
+
+    QVERIFY(image_stream.WaitForFinish(1000));
+    producer.join();
+}
+
+void TestImageStream::TestIncompleteDownload() {
+    flasher::ImageStream image_stream;
+    QVERIFY(image_stream.SetSize(10));
+    QVERIFY(!image_stream.SetSize(11));
+    QVERIFY(image_stream.Append("abc", 3));
+    QVERIFY(!image_stream.Append("0123456789", 10));
+
+    // Download that ends early is not verified even if producer reports success
+    image_stream.Finish(true);
+    QVERIFY(image_stream.WaitForData(3, 0));
+    QVERIFY(!image_stream.WaitForData(4, 1000));
+    QVERIFY(!image_stream.WaitForFinish(1000));
+}
+
+void TestImageStream::TestAbort() {
+    flasher::ImageStream image_stream;
+    QVERIFY(image_stream.SetSize(10));
+
+    // Stalled download times out
+    QVERIFY(!image_stream.WaitForData(1, 20));
+
+    image_stream.Abort();
+    QVERIFY(!image_stream.Append("a", 1));
+    QVERIFY(!image_stream.WaitForData(1, 1000));
+}
+
+void TestImageStream::TestUnknownSize() {
+    flasher::ImageStream image_stream;
+
+    // Size arrives after the timeout, data that is held back until then keeps the wait alive
+    std::thread producer([&image_stream]() {
+        for (int i = 0; i < 10; ++i) {
+            QThread::msleep(10);
+            image_stream.ReportReceived(100);
+        }
+        image_stream.SetSize(1000);
+    });
+
+    QVERIFY(image_stream.WaitForSize(50));
+    producer.join();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QtTest>
+#include "image_stream.h"
+
+class TestImageStream : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestImageStream();
+    ~TestImageStream();
+
+  private slots:
+    void TestStreamedData();
+    void TestIncompleteDownload();
+    void TestAbort();
+    void TestUnknownSize();
+};
@@ -0,0 +1,200 @@
+#include "tst_native_serial_port.h"
+
+#include <atomic>
+#include <thread>
+#include "serial_port.h"
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int kTimeoutInMs {1000};
+
+#ifdef Q_OS_LINUX
+// Master side of a pseudo terminal, the port under test opens the slave side
+class PtyPeer {
+
+  public:
+    PtyPeer() {
+        master_fd_ = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master_fd_ >= 0) {
+            grantpt(master_fd_);
+            unlockpt(master_fd_);
+        }
+    }
+
+    ~PtyPeer() {
+        StopResponder();
+        CloseMaster();
+    }
+
+    QString SlavePath() const {
+        return QString::fromLocal8Bit(ptsname(master_fd_));
+    }
+
+    void Write(const QByteArray& data) {
+        QCOMPARE(write(master_fd_, data.constData(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+
+    QByteArray Read(int size) {
+        QByteArray data;
+        char buffer[256];
+        pollfd poll_fd {master_fd_, POLLIN, 0};
+
+        while ((data.size() < size) && (poll(&poll_fd, 1, kTimeoutInMs) > 0)) {
+            const ssize_t result = read(master_fd_, buffer, sizeof(buffer));
+            if (result <= 0) {
+                break;
+            }
+            data.append(buffer, static_cast<int>(result));
+        }
+
+        return data;
+    }
+
+    void CloseMaster() {
+        if (master_fd_ >= 0) {
+            close(master_fd_);
+            master_fd_ = -1;
+        }
+    }
+
+    // Bootloader that answers NUL terminated requests
+    void StartResponder(const QMap<QByteArray, QByteArray>& replies) {
+        is_running_ = true;
+        responder_ = std::thread([this, replies]() {
+            QByteArray requests;
+            char buffer[256];
+            pollfd poll_fd {master_fd_, POLLIN, 0};
+
+            while (is_running_) {
+                if ((poll(&poll_fd, 1, 10) <= 0) || !(poll_fd.revents & POLLIN)) {
+                    continue;
+                }
+
+                const ssize_t result = read(master_fd_, buffer, sizeof(buffer));
+                if (result > 0) {
+                    requests.append(buffer, static_cast<int>(result));
+                }
+
+                int end;
+                while ((end = requests.indexOf('\0')) >= 0) {
+                    const QByteArray reply = replies.value(requests.left(end));
+                    requests.remove(0, end + 1);
+                    if (!reply.isEmpty()) {
+                        write(master_fd_, reply.constData(), reply.size());
+                    }
+                }
+            }
+        });
+    }
+
+    void StopResponder() {
+        is_running_ = false;
+        if (responder_.joinable()) {
+            responder_.join();
+        }
+    }
+
+    int master_fd_ {-1};
+
+  private:
+    std::atomic<bool> is_running_ {false};
+    std::thread responder_;
+};
+#endif
+
+} // namespace
+
+TestNativeSerialPort::TestNativeSerialPort() = default;
+TestNativeSerialPort::~TestNativeSerialPort() = default;
+
+void TestNativeSerialPort::TestPtyLoopback() {
+#ifdef Q_OS_LINUX
+    PtyPeer peer;
+    QVERIFY(peer.master_fd_ >= 0);
+
+    communication::NativeSerialPort port;
+    QVERIFY(port.Open(peer.SlavePath(), communication::kDefaultBaudRate, false));
+    QVERIFY(!port.WaitForReadyRead(10));
+
+    // Rx data is read in place, more data than the initial buffer forces the buffer to grow
+    QByteArray rx_data(40000, Qt::Uninitialized);
+    for (int i = 0; i < rx_data.size(); ++i) {
+        rx_data[i] = static_cast<char>(i * 13);
+    }
+
+    QByteArray received;
+    for (int offset = 0; offset < rx_data.size(); offset += 1000) {
+        peer.Write(rx_data.mid(offset, 1000));
+        while (port.RxBuffer().Size() < qMin(offset + 1000, rx_data.size()) - received.size()) {
+            QVERIFY(port.WaitForReadyRead(kTimeoutInMs));
+        }
+        received.append(port.RxBuffer().Take(500));
+    }
+    received.append(port.RxBuffer().Take(port.RxBuffer().Size()));
+    QCOMPARE(received, rx_data);
+
+    const QByteArray tx_data("software_type", sizeof("software_type"));
+    QCOMPARE(port.Write(tx_data.constData(), tx_data.size()), static_cast<qint64>(tx_data.size()));
+    QCOMPARE(peer.Read(tx_data.size()), tx_data);
+
+    QVERIFY(port.SetLinkSettings(communication::kHighBaudRate, true));
+    QVERIFY(!port.HasError());
+#else
+    QSKIP("Native serial port is available on Linux only");
+#endif
+}
+
+void TestNativeSerialPort::TestHangup() {
+#ifdef Q_OS_LINUX
+    PtyPeer peer;
+    communication::NativeSerialPort port;
+    QVERIFY(port.Open(peer.SlavePath(), communication::kDefaultBaudRate, false));
+
+    peer.CloseMaster();
+
+    QVERIFY(!port.WaitForReadyRead(kTimeoutInMs));
+    QVERIFY(!port.IsOpen());
+    QVERIFY(port.HasError());
+#else
+    QSKIP("Native serial port is available on Linux only");
+#endif
+}
+
+void TestNativeSerialPort::TestSerialPortOverPty() {
+#ifdef Q_OS_LINUX
+    PtyPeer peer;
+    QMap<QByteArray, QByteArray> replies;
+    replies.insert("software_type", "IMBootloader");
+    replies.insert("version", "1.2.3");
+    peer.StartResponder(replies);
+
+    communication::SerialPort serial_port;
+    serial_port.SetBackend(communication::SerialBackend::kNative);
+    serial_port.SetLinkSettings(communication::kDefaultBaudRate, false);
+
+    bool is_bootloader = false;
+    QVERIFY(serial_port.OpenPort(peer.SlavePath(), is_bootloader));
+    QVERIFY(is_bootloader);
+    QVERIFY(serial_port.IsOpen());
+
+    serial_port.ClearRxData();
+    serial_port.Write("version", sizeof("version"));
+    serial_port.WaitForReadyRead(kTimeoutInMs, [](const communication::ByteView& rx_data) { return rx_data.EqualsIgnoreCase("1.2.3"); });
+
+    QByteArray version;
+    serial_port.ReadData(version);
+    QCOMPARE(version, QByteArray("1.2.3"));
+
+    serial_port.CloseConn();
+    QVERIFY(!serial_port.IsOpen());
+#else
+    QSKIP("Native serial port is available on Linux only");
+#endif
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QtTest>
+#include "native_serial_port.h"
+
+class TestNativeSerialPort : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestNativeSerialPort();
+    ~TestNativeSerialPort();
+
+  private slots:
+    void TestPtyLoopback();
+    void TestHangup();
+    void TestSerialPortOverPty();
+};
@@ -0,0 +1,62 @@
+#include "tst_ring_buffer.h"
+
+#include <cstring>
+
+TestRingBuffer::TestRingBuffer() = default;
+TestRingBuffer::~TestRingBuffer() = default;
+
+void TestRingBuffer::TestWrapAround() {
+    communication::RingBuffer ring_buffer(8);
+    ring_buffer.Append("abcdef", 6);
+    QCOMPARE(ring_buffer.Take(4), QByteArray("abcd"));
+
+    // Free space wraps, producer fills both spans and commits them at once
+    communication::RingBuffer::Span first;
+    communication::RingBuffer::Span second;
+    ring_buffer.GetFreeSpans(first, second);
+    QCOMPARE(first.size + second.size, 6);
+    QCOMPARE(first.size, 2);
+    std::memcpy(first.data, "gh", 2);
+    std::memcpy(second.data, "ijkl", 4);
+    ring_buffer.Commit(6);
+
+    QCOMPARE(ring_buffer.Size(), 8);
+    QCOMPARE(ring_buffer.Capacity(), 8);
+    QCOMPARE(ring_buffer.At(2), 'g');
+    QCOMPARE(QByteArray(ring_buffer.Linearize(), ring_buffer.Size()), QByteArray("efghijkl"));
+
+    ring_buffer.Consume(8);
+    QVERIFY(ring_buffer.IsEmpty());
+}
+
+void TestRingBuffer::TestGrow() {
+    communication::RingBuffer ring_buffer(4);
+    ring_buffer.Append("ab", 2);
+    ring_buffer.Consume(1);
+    ring_buffer.Append("cdefg", 5);
+
+    QVERIFY(ring_buffer.Capacity() >= 6);
+    QCOMPARE(ring_buffer.Take(ring_buffer.Size()), QByteArray("bcdefg"));
+
+    const int capacity = ring_buffer.Capacity();
+    ring_buffer.ReserveFreeSpace(capacity + 1);
+    QVERIFY(ring_buffer.Capacity() >= 2 * capacity);
+}
+
+void TestRingBuffer::TestView() {
+    communication::RingBuffer ring_buffer(4);
+    ring_buffer.Append("xxOK", 4);
+    ring_buffer.Consume(2);
+    ring_buffer.Append("ok", 2);
+
+    communication::ByteView view = ring_buffer.View();
+    QCOMPARE(view.size, 4);
+    QVERIFY(view.EqualsIgnoreCase("okok"));
+    QVERIFY(!view.EqualsIgnoreCase("OK"));
+    QVERIFY(!view.EqualsIgnoreCase("OKOK!"));
+
+    ring_buffer.Consume(2);
+    view = ring_buffer.View();
+    QVERIFY(view.EqualsIgnoreCase("OK"));
+    QVERIFY(!view.EqualsIgnoreCase("NOK"));
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QtTest>
+#include "ring_buffer.h"
+
+class TestRingBuffer : public QObject {
+
+    Q_OBJECT
+
+  public:
+    TestRingBuffer();
+    ~TestRingBuffer();
+
+  private slots:
+    void TestWrapAround();
+    void TestGrow();
+    void TestView();
+};
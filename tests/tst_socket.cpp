@@ -2,11 +2,14 @@
 
 #include <vector>
 #include <QMessageAuthenticationCode>
+#include <QTcpServer>
+#include "fake_server.h"
 
 constexpr char kDefaultAddress1[] {"127.0.0.1"};
 constexpr char kDefaultAddress2[] {"127.0.0.2"}; // "localhost" doesn't work for some reason
 constexpr int kDefaultPort = 5322;
 constexpr char kDefaultKey[] {"NDQ4N2Y1YjFhZTg3ZGI3MTA1MjlhYmM3"};
+constexpr qint64 kRaceTimeLimitInMs {1000};   // Below the socket connect timeout
 
 void CreateServersArray(QJsonArray& json_array) {
     QJsonObject json_object_server_1;
@@ -106,18 +109,6 @@ bool MockSocket_3::waitForConnected(int msecs) {
     return true;
 }
 
-namespace crc {
-uint32_t CalculateCrc32(
-    const uint8_t *data,
-    const uint32_t length,
-    const bool reflected_output,
-    const bool reflected_input) {
-
-    if (*data & length & reflected_output & reflected_input) {}
-    return 0x0;
-}
-} //namespace socket
-
 
 TestSocket::TestSocket() = default;
 TestSocket::~TestSocket() = default;
@@ -313,3 +304,140 @@ void TestSocket::TestSendFail() {
     bool success = socket.ReceiveProductInfo(tx_json_board_info, bl_sw_info, rx_product_info, is_secure_communication);
     QVERIFY2(!success, "Send data did not fail");
 }
+
+void TestSocket::TestDownloadFileStream() {
+    const QByteArray file = CreateFile();
+    FakeServer server(file, true);
+    QJsonArray servers_array;
+    server.CreateServersArray(servers_array);
+    socket::SocketClient socket(std::move(servers_array));
+
+    QByteArray downloaded;
+    QVector<int> chunk_sizes;
+    qint64 announced_size = -1;
+    bool is_size_announced_first = false;
+    QJsonObject server_security_data;
+    const bool success = socket.DownloadFileStream(QJsonObject(), QJsonObject(), "v1.0.0", server_security_data, [&](const char *chunk, int size) {
+        downloaded.append(chunk, size);
+        chunk_sizes.append(size);
+        return true;
+    }, [&](qint64 file_size, quint32) {
+        announced_size = file_size;
+        is_size_announced_first = downloaded.isEmpty();
+        return true;
+    });
+
+    QVERIFY2(success, "Download failed");
+    QCOMPARE(downloaded, file);
+    QCOMPARE(announced_size, static_cast<qint64>(file.size()));
+    QVERIFY(is_size_announced_first);
+
+    // File arrives in fixed size chunks, only the last one is shorter
+    QVERIFY(chunk_sizes.size() > 1);
+    for (int i = 0; i < chunk_sizes.size() - 1; ++i) {
+        QCOMPARE(chunk_sizes.at(i), chunk_sizes.at(0));
+    }
+    QVERIFY(chunk_sizes.last() <= chunk_sizes.at(0));
+}
+
+void TestSocket::TestDownloadFromLegacyServer() {
+    const QByteArray file = CreateFile();
+    FakeServer server(file, false);
+    QJsonArray servers_array;
+    server.CreateServersArray(servers_array);
+    socket::SocketClient socket(std::move(servers_array));
+
+    QByteArray downloaded;
+    QJsonObject server_security_data;
+    const bool success = socket.DownloadFile(QJsonObject(), QJsonObject(), "v1.0.0", server_security_data, downloaded);
+
+    QVERIFY2(success, "Download failed");
+    QCOMPARE(downloaded, file);
+}
+
+void TestSocket::TestSessionReuse() {
+    const QByteArray file = CreateFile();
+    FakeServer server(file, true);
+    QJsonArray servers_array;
+    server.CreateServersArray(servers_array);
+    socket::SocketClient socket(std::move(servers_array));
+
+    QJsonArray product_info;
+    bool is_secure_communication = true;
+    QJsonObject server_security_data;
+    QByteArray downloaded;
+
+    QVERIFY2(socket.SendBoardInfo(QJsonObject(), QJsonObject(), QJsonObject()), "Send board info failed");
+    QVERIFY2(socket.ReceiveProductInfo(QJsonObject(), QJsonObject(), product_info, is_secure_communication), "Receive product info failed");
+    QVERIFY2(socket.DownloadFile(QJsonObject(), QJsonObject(), "v1.0.0", server_security_data, downloaded), "Download failed");
+    socket.CloseSession();
+
+    QVERIFY(!is_secure_communication);
+    QCOMPARE(downloaded, file);
+    QCOMPARE(server.AuthenticationCount(), 1);
+}
+
+void TestSocket::TestSessionReconnect() {
+    const QByteArray file = CreateFile();
+    FakeServer server(file, true, false);
+    QJsonArray servers_array;
+    server.CreateServersArray(servers_array);
+    socket::SocketClient socket(std::move(servers_array));
+
+    QJsonArray product_info;
+    bool is_secure_communication = true;
+    QJsonObject server_security_data;
+    QByteArray downloaded;
+
+    // Server closes the connection after each request, client connects again without failing the request
+    QVERIFY2(socket.SendBoardInfo(QJsonObject(), QJsonObject(), QJsonObject()), "Send board info failed");
+    QVERIFY2(socket.ReceiveProductInfo(QJsonObject(), QJsonObject(), product_info, is_secure_communication), "Receive product info failed");
+    QVERIFY2(socket.DownloadFile(QJsonObject(), QJsonObject(), "v1.0.0", server_security_data, downloaded), "Download failed");
+
+    QCOMPARE(downloaded, file);
+    QCOMPARE(server.AuthenticationCount(), 3);
+}
+
+void TestSocket::TestServerRace() {
+    const QByteArray file = CreateFile();
+    FakeServer server(file, true);
+    QJsonArray servers_array;
+
+    // Port that nobody listens on
+    QTcpServer closed_server;
+    closed_server.listen(QHostAddress(kDefaultAddress1));
+    const quint16 closed_port = closed_server.serverPort();
+    closed_server.close();
+
+    QJsonObject json_object_server;
+    json_object_server.insert("address", kDefaultAddress1);
+    json_object_server.insert("port", closed_port);
+    json_object_server.insert("preshared_key", kDefaultKey);
+    servers_array.append(json_object_server);
+    server.CreateServersArray(servers_array);
+
+    const QString closed_server_key = QString(kDefaultAddress1) + ':' + QString::number(closed_port);
+    const QString server_key = QString(kDefaultAddress1) + ':' + QString::number(servers_array.at(1).toObject().value("port").toInt());
+
+    socket::SocketClient socket(std::move(servers_array));
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY2(socket.SendBoardInfo(QJsonObject(), QJsonObject(), QJsonObject()), "Send board info failed");
+    socket.CloseSession();
+
+    // Refused connect starts the next server right away, failed server does not cost the connect timeout
+    QVERIFY(timer.elapsed() < kRaceTimeLimitInMs);
+
+    // Failed server is ranked last, working one is measured
+    const QHash<QString, int> server_rtts = socket.ServerRtts();
+    QVERIFY(server_rtts.value(closed_server_key) > server_rtts.value(server_key));
+    QVERIFY(server_rtts.contains(server_key));
+    QCOMPARE(server.AuthenticationCount(), 1);
+
+    // Working server is ranked first now, connection that wins the race is used for the request
+    const int connection_count = server.ConnectionCount();
+    QVERIFY2(socket.SendBoardInfo(QJsonObject(), QJsonObject(), QJsonObject()), "Send board info failed");
+    socket.CloseSession();
+    QCOMPARE(server.AuthenticationCount(), 2);
+    QCOMPARE(server.ConnectionCount(), connection_count + 1);
+}
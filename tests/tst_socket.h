@@ -16,4 +16,9 @@ class TestSocket : public QObject {
     void TestReceiveProductType();
     void TestReadFail();
     void TestSendFail();
+    void TestDownloadFileStream();
+    void TestDownloadFromLegacyServer();
+    void TestSessionReuse();
+    void TestSessionReconnect();
+    void TestServerRace();
 };